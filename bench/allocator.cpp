@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+namespace
+{
+    // mixed small objects: tables, strings and closures
+    constexpr auto script = R"(
+        function churn(n)
+            local items = {}
+            for i = 1, n do
+                local name = "item" .. i
+                items[i] = { name = name, get = function() return name end }
+            end
+            local total = 0
+            for _, item in ipairs(items) do
+                total = total + #item.get()
+            end
+            return total
+        end
+    )";
+
+    void run(benchmark::State& s, nil::luax::State& state)
+    {
+        state.open_libs();
+        state.run(script);
+        const auto churn = state.get("churn").as<nil::luax::Function<int(int)>>();
+        for (auto _ : s)
+        {
+            benchmark::DoNotOptimize(churn(1000));
+        }
+    }
+}
+
+void allocator_default(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    run(s, state);
+}
+
+void allocator_pool(benchmark::State& s)
+{
+    auto allocator = nil::luax::PoolAllocator();
+    auto state = nil::luax::State(allocator);
+    run(s, state);
+}
+
+BENCHMARK(allocator_default);
+BENCHMARK(allocator_pool);
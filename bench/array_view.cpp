@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr auto sample_count = 10000;
+
+    // scales every `stride`th sample in place and returns their sum
+    constexpr auto script = R"(
+        function process(samples, stride)
+            local total = 0
+            for i = 1, #samples, stride do
+                local v = samples[i] * 0.5
+                samples[i] = v
+                total = total + v
+            end
+            return total
+        end
+        function process_copy(samples, stride)
+            return samples, process(samples, stride)
+        end
+    )";
+}
+
+// the buffer is copied to a table and back
+void array_view_table_copy(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(script);
+    const auto process = state.get("process_copy")
+                             .as<nil::luax::Function<std::tuple<std::vector<float>, double>(
+                                 const std::vector<float>&,
+                                 int
+                             )>>();
+    auto samples = std::vector<float>(sample_count, 1.0f);
+    for (auto _ : s)
+    {
+        auto [result, total] = process(samples, int(s.range(0)));
+        samples = std::move(result);
+        benchmark::DoNotOptimize(total);
+    }
+    s.SetItemsProcessed(s.iterations() * sample_count);
+}
+
+// the script works on the buffer itself
+void array_view_in_place(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(script);
+    const auto process
+        = state.get("process").as<nil::luax::Function<double(nil::luax::ArrayView<float>, int)>>();
+    auto samples = std::vector<float>(sample_count, 1.0f);
+    for (auto _ : s)
+    {
+        const auto stride = int(s.range(0));
+        benchmark::DoNotOptimize(process(nil::luax::ArrayView<float>(samples), stride));
+    }
+    s.SetItemsProcessed(s.iterations() * sample_count);
+}
+
+// every sample, then one in 16
+BENCHMARK(array_view_table_copy)->Arg(1)->Arg(16);
+BENCHMARK(array_view_in_place)->Arg(1)->Arg(16);
@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <chrono>
+
+namespace
+{
+    void run(benchmark::State& s, nil::luax::State& state)
+    {
+        state.run(R"(
+            function spin(n)
+                local total = 0
+                for i = 1, n do
+                    total = total + i % 3
+                end
+                return total
+            end
+        )");
+        const auto spin = state.get("spin").as<nil::luax::Function<int(int)>>();
+        for (auto _ : s)
+        {
+            benchmark::DoNotOptimize(spin(100000));
+        }
+    }
+}
+
+void budget_none(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    run(s, state);
+}
+
+void budget_instructions(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.set_budget({.instructions = std::uint64_t(1) << 62u});
+    run(s, state);
+}
+
+void budget_deadline(benchmark::State& s)
+{
+    using namespace std::chrono_literals;
+    auto state = nil::luax::State();
+    state.set_budget({.duration = 24h});
+    run(s, state);
+}
+
+BENCHMARK(budget_none);
+BENCHMARK(budget_instructions);
+BENCHMARK(budget_deadline);
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    constexpr auto frame_size = 4 * 1024 * 1024;
+
+    // reads the header of a frame, the payload is left untouched
+    constexpr auto script = R"(
+        function parse(frame)
+            return #frame + frame:byte(1)
+        end
+        function parse_bytes(frame)
+            return #frame + frame[1]
+        end
+    )";
+}
+
+// the frame is copied to a lua string
+void bytes_frame_string(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.run(script);
+    const auto parse
+        = state.get("parse").as<nil::luax::Function<std::int64_t(std::string_view)>>();
+    const auto frame = std::string(frame_size, '\x01');
+    for (auto _ : s)
+    {
+        benchmark::DoNotOptimize(parse(frame));
+    }
+    s.SetBytesProcessed(s.iterations() * frame_size);
+}
+
+// the frame is borrowed by a `Bytes` userdata
+void bytes_frame_view(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.run(script);
+    const auto parse
+        = state.get("parse_bytes").as<nil::luax::Function<std::int64_t(nil::luax::Bytes)>>();
+    const auto frame = std::string(frame_size, '\x01');
+    for (auto _ : s)
+    {
+        benchmark::DoNotOptimize(parse(nil::luax::Bytes(std::as_bytes(std::span(frame)))));
+    }
+    s.SetBytesProcessed(s.iterations() * frame_size);
+}
+
+BENCHMARK(bytes_frame_string);
+BENCHMARK(bytes_frame_view);
@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <filesystem>
+#include <string>
+
+namespace
+{
+    std::string make_script(int functions)
+    {
+        auto script = std::string();
+        for (auto i = 0; i < functions; ++i)
+        {
+            const auto name = "f" + std::to_string(i);
+            script += "function " + name + "(a, b)\n";
+            script += "    local t = {a = a, b = b, name = '" + name + "'}\n";
+            script += "    for i = 1, 10 do t.a = t.a + i * b end\n";
+            script += "    return t.a, t.b, t.name\n";
+            script += "end\n";
+        }
+        return script;
+    }
+}
+
+void chunk_cache_disabled(benchmark::State& s)
+{
+    const auto script = make_script(int(s.range(0)));
+    for (auto _ : s)
+    {
+        auto state = nil::luax::State();
+        state.run(script);
+    }
+    s.SetBytesProcessed(s.iterations() * std::int64_t(script.size()));
+}
+
+void chunk_cache_enabled(benchmark::State& s)
+{
+    const auto script = make_script(int(s.range(0)));
+    const auto directory = std::filesystem::temp_directory_path() / "luax-bench-chunk-cache";
+    auto cache = nil::luax::ChunkCache(directory);
+    for (auto _ : s)
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(script);
+    }
+    s.SetBytesProcessed(s.iterations() * std::int64_t(script.size()));
+    cache.clear();
+}
+
+BENCHMARK(chunk_cache_disabled)->Arg(100)->Arg(2000);
+BENCHMARK(chunk_cache_enabled)->Arg(100)->Arg(2000);
@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <string>
+
+struct Shape
+{
+    Shape() = default;
+
+    explicit Shape(double init_x)
+        : x(init_x)
+    {
+    }
+
+    Shape(double init_x, double init_y)
+        : x(init_x)
+        , y(init_y)
+    {
+    }
+
+    Shape(const std::string& init_name, double init_x, double init_y)
+        : name(init_name)
+        , x(init_x)
+        , y(init_y)
+    {
+    }
+
+    std::string name;
+    double x = 0.0;
+    double y = 0.0;
+};
+
+template <>
+struct nil::luax::Meta<Shape>
+{
+    using Constructors = nil::luax::List<
+        nil::luax::Constructor<>,
+        nil::luax::Constructor<double>,
+        nil::luax::Constructor<double, double>,
+        nil::luax::Constructor<std::string, double, double>>;
+};
+
+constexpr auto calls_per_iteration = 1000;
+
+void constructor_overload(benchmark::State& s, const char* args)
+{
+    auto state = nil::luax::State();
+    state.add_type<Shape>("Shape");
+    state.run(
+        "function construct(n) for i = 1, n do local shape = Shape(" + std::string(args)
+        + ") end end"
+    );
+
+    auto construct = state.get("construct").as<void(int)>();
+    for (auto _ : s)
+    {
+        construct(calls_per_iteration);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+BENCHMARK_CAPTURE(constructor_overload, first, "");
+BENCHMARK_CAPTURE(constructor_overload, second, "1.0");
+BENCHMARK_CAPTURE(constructor_overload, third, "1.0, 2.0");
+BENCHMARK_CAPTURE(constructor_overload, last, "'name', 1.0, 2.0");
+
+struct Vec3
+{
+    Vec3() = default;
+
+    Vec3(double init_x, double init_y, double init_z)
+        : x(init_x)
+        , y(init_y)
+        , z(init_z)
+    {
+    }
+
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+};
+
+template <>
+struct nil::luax::Meta<Vec3>
+{
+    using Constructors = nil::luax::List<
+        nil::luax::Constructor<double, double, double>,
+        nil::luax::Constructor<const Vec3&>,
+        nil::luax::Constructor<>>;
+};
+
+void constructor_vec3(benchmark::State& s, const char* args)
+{
+    auto state = nil::luax::State();
+    state.add_type<Vec3>("Vec3");
+    state.run("source = Vec3(1.0, 2.0, 3.0)");
+    state.run(
+        "function construct(n) for i = 1, n do local v = Vec3(" + std::string(args) + ") end end"
+    );
+
+    auto construct = state.get("construct").as<void(int)>();
+    for (auto _ : s)
+    {
+        construct(calls_per_iteration);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+BENCHMARK_CAPTURE(constructor_vec3, xyz, "1.0, 2.0, 3.0");
+BENCHMARK_CAPTURE(constructor_vec3, copy, "source");
+BENCHMARK_CAPTURE(constructor_vec3, empty, "");
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    constexpr auto element_count = 10000;
+
+    std::vector<double> make_values()
+    {
+        auto values = std::vector<double>(element_count);
+        std::iota(values.begin(), values.end(), 0.0);
+        return values;
+    }
+}
+
+// c++ -> lua -> c++ through the container TypeDefs
+void container_vector_round_trip(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run("function identity(values) return values end");
+    const auto identity
+        = state.get("identity").as<nil::luax::Function<std::vector<double>(std::vector<double>)>>();
+    const auto values = make_values();
+    for (auto _ : s)
+    {
+        benchmark::DoNotOptimize(identity(values));
+    }
+    s.SetItemsProcessed(s.iterations() * element_count);
+}
+
+// the usual hand-rolled marshaling: the table grows one element at a time
+void container_vector_round_trip_manual(benchmark::State& s)
+{
+    auto* state = luaL_newstate();
+    luaL_dostring(state, "function identity(values) return values end");
+    const auto values = make_values();
+    for (auto _ : s)
+    {
+        lua_getglobal(state, "identity");
+        lua_newtable(state);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            lua_pushnumber(state, values[i]);
+            lua_seti(state, -2, lua_Integer(i + 1));
+        }
+        lua_call(state, 1, 1);
+        auto result = std::vector<double>();
+        const auto size = luaL_len(state, -1);
+        for (lua_Integer i = 1; i <= size; ++i)
+        {
+            lua_geti(state, -1, i);
+            result.push_back(lua_tonumber(state, -1));
+            lua_pop(state, 1);
+        }
+        lua_pop(state, 1);
+        benchmark::DoNotOptimize(result);
+    }
+    lua_close(state);
+    s.SetItemsProcessed(s.iterations() * element_count);
+}
+
+BENCHMARK(container_vector_round_trip);
+BENCHMARK(container_vector_round_trip_manual);
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <coroutine>
+#include <vector>
+
+namespace
+{
+    std::vector<std::coroutine_handle<>> pending; // NOLINT
+
+    // stands for an i/o completing on the next turn of the event loop
+    struct Io
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) const
+        {
+            pending.push_back(handle);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    nil::luax::Async<int> request(int id)
+    {
+        co_await Io();
+        co_return id;
+    }
+
+    void drain()
+    {
+        while (!pending.empty())
+        {
+            auto ready = std::move(pending);
+            pending.clear();
+            for (auto handle : ready)
+            {
+                handle.resume();
+            }
+        }
+    }
+}
+
+// `range(0)` sessions, each waiting on two requests, multiplexed on one state
+void coroutine_sessions(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.set("request", &request);
+    state.run("function session(id) return request(id) + request(id) end");
+    const auto session = state.get("session");
+    const auto count = int(s.range(0));
+
+    auto sessions = std::vector<nil::luax::Coroutine<int>>();
+    sessions.reserve(std::size_t(count));
+    for (auto _ : s)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            sessions.push_back(state.spawn<int>(session, i));
+        }
+        drain();
+        benchmark::DoNotOptimize(sessions.back().result());
+        sessions.clear();
+    }
+    s.SetItemsProcessed(s.iterations() * count);
+}
+
+BENCHMARK(coroutine_sessions)->Arg(1)->Arg(1000);
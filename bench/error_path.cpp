@@ -0,0 +1,64 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <stdexcept>
+
+constexpr auto calls_per_iteration = 1000;
+
+constexpr auto validator = R"(
+    function validate(value)
+        if value % 2 == 0 then
+            return "invalid"
+        end
+        return value
+    end
+)";
+
+void error_path_throw(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(validator);
+
+    auto validate = state.get("validate").as<nil::luax::Function<int(int)>>();
+    for (auto _ : s)
+    {
+        auto failures = 0;
+        for (auto i = 0; i < calls_per_iteration; ++i)
+        {
+            try
+            {
+                benchmark::DoNotOptimize(validate(i));
+            }
+            catch (const std::exception&)
+            {
+                ++failures;
+            }
+        }
+        benchmark::DoNotOptimize(failures);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+void error_path_result(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(validator);
+
+    auto validate = state.get("validate").as<nil::luax::Function<int(int)>>();
+    for (auto _ : s)
+    {
+        auto failures = 0;
+        for (auto i = 0; i < calls_per_iteration; ++i)
+        {
+            const auto result = validate.try_call(i);
+            failures += result ? 0 : 1;
+            benchmark::DoNotOptimize(result);
+        }
+        benchmark::DoNotOptimize(failures);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+BENCHMARK(error_path_throw);
+BENCHMARK(error_path_result);
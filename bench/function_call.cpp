@@ -0,0 +1,86 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <functional>
+#include <numeric>
+#include <vector>
+
+constexpr auto calls_per_iteration = 1000;
+
+constexpr auto handler = R"(
+    function handler(event, value)
+        return event + value
+    end
+)";
+
+void function_std_function(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(handler);
+
+    std::function<int(int, int)> fn = state.get("handler");
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < calls_per_iteration; ++i)
+        {
+            benchmark::DoNotOptimize(fn(i, 1));
+        }
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+void function_handle(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(handler);
+
+    auto fn = state.get("handler").as<nil::luax::Function<int(int, int)>>();
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < calls_per_iteration; ++i)
+        {
+            benchmark::DoNotOptimize(fn(i, 1));
+        }
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+void function_pinned(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(handler);
+
+    auto fn = state.get("handler").as<nil::luax::Function<int(int, int)>>();
+    auto pinned = fn.pin();
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < calls_per_iteration; ++i)
+        {
+            benchmark::DoNotOptimize(pinned(i, 1));
+        }
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+void function_call_each(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run(handler);
+
+    auto fn = state.get("handler").as<nil::luax::Function<int(int, int)>>();
+    auto events = std::vector<int>(calls_per_iteration);
+    auto values = std::vector<int>(calls_per_iteration, 1);
+    auto out = std::vector<int>(calls_per_iteration);
+    std::iota(events.begin(), events.end(), 0);
+    for (auto _ : s)
+    {
+        benchmark::DoNotOptimize(fn.call_each(out, events, values));
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+BENCHMARK(function_std_function);
+BENCHMARK(function_handle);
+BENCHMARK(function_pinned);
+BENCHMARK(function_call_each);
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <chrono>
+
+namespace
+{
+    // live data the collector has to traverse, plus garbage produced by every frame
+    void setup(nil::luax::State& state)
+    {
+        state.open_libs();
+        state.run(R"(
+            live = {}
+            for i = 1, 100000 do
+                live[i] = { i, tostring(i) }
+            end
+            function frame()
+                for i = 1, 1000 do
+                    local t = { i, tostring(i) }
+                end
+            end
+        )");
+    }
+}
+
+// time of one frame followed by a full collection
+void gc_full(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    setup(state);
+    state.set_gc_running(false);
+    const auto frame = state.get("frame").as<nil::luax::Function<void()>>();
+    for (auto _ : s)
+    {
+        frame();
+        state.gc();
+    }
+}
+
+// time of one frame followed by a bounded collection step
+void gc_step(benchmark::State& s)
+{
+    using namespace std::chrono_literals;
+    auto state = nil::luax::State();
+    setup(state);
+    state.set_gc_running(false);
+    const auto frame = state.get("frame").as<nil::luax::Function<void()>>();
+    for (auto _ : s)
+    {
+        frame();
+        state.gc_step(200us);
+    }
+}
+
+BENCHMARK(gc_full);
+BENCHMARK(gc_step);
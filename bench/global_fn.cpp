@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <functional>
+
+constexpr auto calls_per_iteration = 1000;
+
+int add_free(int a, int b)
+{
+    return a + b;
+}
+
+struct Adder
+{
+    int offset = 0;
+
+    int add(int a, int b)
+    {
+        return a + b + offset;
+    }
+};
+
+template <typename Setup>
+void run_global_fn(benchmark::State& s, const Setup& setup)
+{
+    auto state = nil::luax::State();
+    setup(state);
+    state.run(R"(
+        function call(n)
+            local total = 0
+            for i = 1, n do
+                total = add(total, i)
+            end
+            return total
+        end
+    )");
+
+    auto call = state.get("call").as<int(int)>();
+    for (auto _ : s)
+    {
+        benchmark::DoNotOptimize(call(calls_per_iteration));
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+void global_fn_lambda(benchmark::State& s)
+{
+    run_global_fn(s, [](auto& state) { state.set("add", [](int a, int b) { return a + b; }); });
+}
+
+void global_fn_std_function(benchmark::State& s)
+{
+    run_global_fn(
+        s,
+        [](auto& state)
+        { state.set("add", std::function<int(int, int)>([](int a, int b) { return a + b; })); }
+    );
+}
+
+void global_fn_free_function(benchmark::State& s)
+{
+    run_global_fn(s, [](auto& state) { state.set("add", &add_free); });
+}
+
+void global_fn_member_function(benchmark::State& s)
+{
+    auto adder = Adder();
+    run_global_fn(s, [&adder](auto& state) { state.set("add", &Adder::add, &adder); });
+}
+
+void global_fn_bound_free_function(benchmark::State& s)
+{
+    run_global_fn(s, [](auto& state) { state.template set<&add_free>("add"); });
+}
+
+void global_fn_bound_member_function(benchmark::State& s)
+{
+    auto adder = Adder();
+    run_global_fn(s, [&adder](auto& state) { state.template set<&Adder::add>("add", &adder); });
+}
+
+BENCHMARK(global_fn_lambda);
+BENCHMARK(global_fn_std_function);
+BENCHMARK(global_fn_free_function);
+BENCHMARK(global_fn_member_function);
+BENCHMARK(global_fn_bound_free_function);
+BENCHMARK(global_fn_bound_member_function);
@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+// X-macros to generate types with a growing number of properties.
+// `last` is always the final member which is the worst case for a linear search.
+
+#define NIL_FIELDS_8(X, P) X(P##0) X(P##1) X(P##2) X(P##3) X(P##4) X(P##5) X(P##6) X(P##7)
+
+#define NIL_FIELDS_64(X)                                                                           \
+    NIL_FIELDS_8(X, m0)                                                                            \
+    NIL_FIELDS_8(X, m1)                                                                            \
+    NIL_FIELDS_8(X, m2)                                                                            \
+    NIL_FIELDS_8(X, m3)                                                                            \
+    NIL_FIELDS_8(X, m4)                                                                            \
+    NIL_FIELDS_8(X, m5)                                                                            \
+    NIL_FIELDS_8(X, m6)                                                                            \
+    NIL_FIELDS_8(X, m7)
+
+#define NIL_FIELD(NAME) double NAME = 0.0;
+
+struct Members1
+{
+    double last = 1.0;
+};
+
+struct Members9
+{
+    NIL_FIELDS_8(NIL_FIELD, m)
+    double last = 1.0;
+};
+
+struct Members65
+{
+    NIL_FIELDS_64(NIL_FIELD)
+    double last = 1.0;
+};
+
+#define NIL_PROPERTY(NAME) nil::luax::Property<#NAME, &TYPE::NAME>,
+
+template <>
+struct nil::luax::Meta<Members1>
+{
+    using Members = nil::luax::List<nil::luax::Property<"last", &Members1::last>>;
+};
+
+#define TYPE Members9
+
+template <>
+struct nil::luax::Meta<Members9>
+{
+    using Members = nil::luax::List<
+        NIL_FIELDS_8(NIL_PROPERTY, m) nil::luax::Property<"last", &Members9::last>>;
+};
+
+#undef TYPE
+#define TYPE Members65
+
+template <>
+struct nil::luax::Meta<Members65>
+{
+    using Members = nil::luax::List<
+        NIL_FIELDS_64(NIL_PROPERTY) nil::luax::Property<"last", &Members65::last>>;
+};
+
+#undef TYPE
+
+constexpr auto accesses_per_call = 1000;
+
+template <typename T>
+void member_get(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.add_type<T>();
+    state.run(R"(
+        function get(v, n)
+            local sum = 0
+            for i = 1, n do
+                sum = sum + v.last
+            end
+            return sum
+        end
+    )");
+
+    auto get = state.get("get").as<double(T&, int)>();
+    T value;
+    for (auto _ : s)
+    {
+        benchmark::DoNotOptimize(get(value, accesses_per_call));
+    }
+    s.SetItemsProcessed(s.iterations() * accesses_per_call);
+}
+
+template <typename T>
+void member_set(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.add_type<T>();
+    state.run(R"(
+        function set(v, n)
+            for i = 1, n do
+                v.last = i
+            end
+        end
+    )");
+
+    auto set = state.get("set").as<void(T&, int)>();
+    T value;
+    for (auto _ : s)
+    {
+        set(value, accesses_per_call);
+        benchmark::DoNotOptimize(value.last);
+    }
+    s.SetItemsProcessed(s.iterations() * accesses_per_call);
+}
+
+BENCHMARK_TEMPLATE(member_get, Members1);
+BENCHMARK_TEMPLATE(member_get, Members9);
+BENCHMARK_TEMPLATE(member_get, Members65);
+BENCHMARK_TEMPLATE(member_set, Members1);
+BENCHMARK_TEMPLATE(member_set, Members9);
+BENCHMARK_TEMPLATE(member_set, Members65);
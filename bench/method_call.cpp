@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+struct Counter
+{
+    int count = 0;
+
+    void increment()
+    {
+        ++count;
+    }
+};
+
+struct CounterWithProperty
+{
+    int count = 0;
+
+    void increment()
+    {
+        ++count;
+    }
+};
+
+template <>
+struct nil::luax::Meta<Counter>
+{
+    using Members = nil::luax::List<nil::luax::Method<"increment", &Counter::increment>>;
+};
+
+template <>
+struct nil::luax::Meta<CounterWithProperty>
+{
+    using Members = nil::luax::List<
+        nil::luax::Property<"count", &CounterWithProperty::count>,
+        nil::luax::Method<"increment", &CounterWithProperty::increment>>;
+};
+
+constexpr auto calls_per_iteration = 1000;
+
+template <typename T>
+void method_call(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.add_type<T>();
+    state.run(R"(
+        function call(v, n)
+            for i = 1, n do
+                v:increment()
+            end
+        end
+    )");
+
+    auto call = state.get("call").as<void(T&, int)>();
+    T value;
+    for (auto _ : s)
+    {
+        call(value, calls_per_iteration);
+        benchmark::DoNotOptimize(value.count);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+BENCHMARK_TEMPLATE(method_call, Counter);
+BENCHMARK_TEMPLATE(method_call, CounterWithProperty);
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+namespace
+{
+    void run(benchmark::State& s, nil::luax::State& state)
+    {
+        state.run(R"(
+            local function leaf(n)
+                local total = 0
+                for i = 1, n do
+                    total = total + i % 3
+                end
+                return total
+            end
+            function work(n)
+                local total = 0
+                for i = 1, n do
+                    total = total + leaf(100)
+                end
+                return total
+            end
+        )");
+        const auto work = state.get("work").as<nil::luax::Function<int(int)>>();
+        for (auto _ : s)
+        {
+            benchmark::DoNotOptimize(work(1000));
+        }
+    }
+}
+
+void profiler_off(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    run(s, state);
+}
+
+void profiler_on(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.start_profiler();
+    run(s, state);
+}
+
+BENCHMARK(profiler_off);
+BENCHMARK(profiler_on);
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <functional>
+#include <vector>
+
+constexpr auto vars_per_iteration = 1000;
+
+void var_get_drop(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run("value = {}");
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < vars_per_iteration; ++i)
+        {
+            auto var = state.get("value");
+            benchmark::DoNotOptimize(var);
+        }
+    }
+    s.SetItemsProcessed(s.iterations() * vars_per_iteration);
+}
+
+void var_copy(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run("value = {}");
+    const auto var = state.get("value");
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < vars_per_iteration; ++i)
+        {
+            auto copy = var;
+            benchmark::DoNotOptimize(copy);
+        }
+    }
+    s.SetItemsProcessed(s.iterations() * vars_per_iteration);
+}
+
+void var_hold_many(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.run("value = {}");
+    auto vars = std::vector<nil::luax::Var>();
+    vars.reserve(std::size_t(s.range(0)));
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < s.range(0); ++i)
+        {
+            vars.push_back(state.get("value"));
+        }
+        vars.clear();
+    }
+    s.SetItemsProcessed(s.iterations() * s.range(0));
+}
+
+void callback_arg(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.set(
+        "accept",
+        [](const std::function<int(int)>& callback) { benchmark::DoNotOptimize(callback); }
+    );
+    state.run(R"(
+        local function callback(v) return v end
+        function call(n)
+            for i = 1, n do
+                accept(callback)
+            end
+        end
+    )");
+
+    auto call = state.get("call").as<void(int)>();
+    for (auto _ : s)
+    {
+        call(vars_per_iteration);
+    }
+    s.SetItemsProcessed(s.iterations() * vars_per_iteration);
+}
+
+BENCHMARK(var_get_drop);
+BENCHMARK(var_copy);
+BENCHMARK(var_hold_many)->Arg(1000)->Arg(100000);
+BENCHMARK(callback_arg);
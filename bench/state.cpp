@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+void state_construct(benchmark::State& s)
+{
+    for (auto _ : s)
+    {
+        auto state = nil::luax::State();
+        benchmark::DoNotOptimize(state);
+    }
+}
+
+void state_construct_open_libs(benchmark::State& s)
+{
+    for (auto _ : s)
+    {
+        auto state = nil::luax::State();
+        state.open_libs();
+        benchmark::DoNotOptimize(state);
+    }
+}
+
+BENCHMARK(state_construct);
+BENCHMARK(state_construct_open_libs);
@@ -0,0 +1,85 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr auto workers = 4;
+    constexpr auto jobs = 64;
+
+    void setup(nil::luax::State& state)
+    {
+        state.run(R"(
+            function work(n)
+                local total = 0
+                for i = 1, n do
+                    total = total + i % 7
+                end
+                return total
+            end
+        )");
+    }
+}
+
+// baseline: every thread serializes through one mutex-guarded state
+void state_pool_single_state(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    setup(state);
+    auto mutex = std::mutex();
+    for (auto _ : s)
+    {
+        auto next = std::atomic<int>(0);
+        auto threads = std::vector<std::thread>();
+        for (auto i = 0; i < workers; ++i)
+        {
+            threads.emplace_back(
+                [&]()
+                {
+                    while (next.fetch_add(1) < jobs)
+                    {
+                        const auto lock = std::lock_guard(mutex);
+                        benchmark::DoNotOptimize(
+                            state.get("work").as<std::function<int(int)>>()(10000)
+                        );
+                    }
+                }
+            );
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+void state_pool_submit(benchmark::State& s)
+{
+    auto pool = nil::luax::StatePool(workers, setup);
+    auto results = std::vector<std::future<int>>();
+    results.reserve(jobs);
+    for (auto _ : s)
+    {
+        for (auto i = 0; i < jobs; ++i)
+        {
+            results.push_back(pool.submit(
+                [](nil::luax::State& state)
+                { return state.get("work").as<std::function<int(int)>>()(10000); }
+            ));
+        }
+        for (auto& result : results)
+        {
+            benchmark::DoNotOptimize(result.get());
+        }
+        results.clear();
+    }
+}
+
+BENCHMARK(state_pool_single_state)->UseRealTime();
+BENCHMARK(state_pool_submit)->UseRealTime();
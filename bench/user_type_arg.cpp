@@ -0,0 +1,80 @@
+#include <benchmark/benchmark.h>
+
+#include <nil/luax.hpp>
+
+struct Point
+{
+    double x = 0.0;
+    double y = 0.0;
+};
+
+template <>
+struct nil::luax::Meta<Point>
+{
+    using Constructors = nil::luax::List<nil::luax::Constructor<double, double>>;
+};
+
+constexpr auto calls_per_iteration = 1000;
+
+void user_type_lua_to_cpp(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.add_type<Point>("Point");
+    state.set("accept", [](Point& p) { return p.x + p.y; });
+    state.run(R"(
+        point = Point(1.0, 2.0)
+        function call(n)
+            for i = 1, n do
+                accept(point)
+            end
+        end
+    )");
+
+    auto call = state.get("call").as<void(int)>();
+    for (auto _ : s)
+    {
+        call(calls_per_iteration);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+void user_type_cpp_to_lua(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.add_type<Point>();
+    state.run(R"(
+        function accept(point)
+        end
+    )");
+
+    auto accept = state.get("accept").as<void(Point&)>();
+    Point point;
+    for (auto _ : s)
+    {
+        accept(point);
+    }
+}
+
+void user_type_construct(benchmark::State& s)
+{
+    auto state = nil::luax::State();
+    state.add_type<Point>("Point");
+    state.run(R"(
+        function construct(n)
+            for i = 1, n do
+                local p = Point(1.0, 2.0)
+            end
+        end
+    )");
+
+    auto construct = state.get("construct").as<void(int)>();
+    for (auto _ : s)
+    {
+        construct(calls_per_iteration);
+    }
+    s.SetItemsProcessed(s.iterations() * calls_per_iteration);
+}
+
+BENCHMARK(user_type_lua_to_cpp);
+BENCHMARK(user_type_cpp_to_lua);
+BENCHMARK(user_type_construct);
@@ -0,0 +1,18 @@
+set(ENABLE_BENCHMARK OFF CACHE BOOL "[0 | OFF - 1 | ON]: build benchmarks?")
+
+if(ENABLE_BENCHMARK)
+    find_package(benchmark CONFIG REQUIRED)
+endif()
+
+function(add_bench_executable TARGET)
+    add_executable(${TARGET} ${ARGN})
+    if(ENABLE_CLANG_TIDY AND CMAKE_CXX_CLANG_TIDY)
+        set_target_properties(${TARGET} PROPERTIES CXX_CLANG_TIDY "${CMAKE_CXX_CLANG_TIDY};-checks=-readability-function-cognitive-complexity")
+    endif()
+endfunction()
+
+function(add_bench_subdirectory)
+    if(ENABLE_BENCHMARK)
+        add_subdirectory(bench)
+    endif()
+endfunction()
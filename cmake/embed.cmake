@@ -0,0 +1,49 @@
+# target_embed_lua(<target> <symbol> [BASE_DIR <dir>] FILES <file>...)
+#
+# compiles the lua files to bytecode at build time (see `tool/`) and generates `<symbol>.hpp`
+# declaring `inline constexpr nil::luax::EmbeddedModule <symbol>[]`, to be registered with
+# `State::add_embedded`.
+#
+# module names are the paths relative to BASE_DIR (defaults to the current source directory)
+# without the `.lua` extension and with `/` replaced by `.` (`a/b.lua` -> `a.b`).
+#
+# uses the `luax-embed` target of the build tree (ENABLE_EMBED_TOOL) or, from an installed
+# package, the imported `nil::luax-embed`.
+function(target_embed_lua TARGET SYMBOL)
+    cmake_parse_arguments(EMBED "" "BASE_DIR" "FILES" ${ARGN})
+    if(TARGET luax-embed)
+        set(EMBED_TOOL luax-embed)
+    elseif(TARGET nil::luax-embed)
+        set(EMBED_TOOL nil::luax-embed)
+    else()
+        message(FATAL_ERROR "target_embed_lua: luax-embed is not available (ENABLE_EMBED_TOOL)")
+    endif()
+    if(NOT EMBED_BASE_DIR)
+        set(EMBED_BASE_DIR ${CMAKE_CURRENT_SOURCE_DIR})
+    endif()
+
+    set(OUTPUT_DIR ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}-embed)
+    set(OUTPUT ${OUTPUT_DIR}/${SYMBOL}.hpp)
+
+    set(MODULES)
+    set(DEPENDS)
+    foreach(FILE ${EMBED_FILES})
+        get_filename_component(FILE ${FILE} ABSOLUTE BASE_DIR ${CMAKE_CURRENT_SOURCE_DIR})
+        file(RELATIVE_PATH MODULE ${EMBED_BASE_DIR} ${FILE})
+        string(REGEX REPLACE "\\.lua$" "" MODULE ${MODULE})
+        string(REPLACE "/" "." MODULE ${MODULE})
+        list(APPEND MODULES "${MODULE}=${FILE}")
+        list(APPEND DEPENDS ${FILE})
+    endforeach()
+
+    add_custom_command(
+        OUTPUT ${OUTPUT}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${OUTPUT_DIR}
+        COMMAND ${EMBED_TOOL} ${OUTPUT} ${SYMBOL} ${MODULES}
+        DEPENDS ${EMBED_TOOL} ${DEPENDS}
+        COMMENT "embedding lua modules [${SYMBOL}]"
+        VERBATIM
+    )
+    target_sources(${TARGET} PRIVATE ${OUTPUT})
+    target_include_directories(${TARGET} PRIVATE ${OUTPUT_DIR})
+endfunction()
@@ -0,0 +1,7 @@
+set(ENABLE_EMBED_TOOL ON CACHE BOOL "[0 | OFF - 1 | ON]: build luax-embed (used by target_embed_lua)?")
+
+function(add_tool_subdirectory)
+    if(ENABLE_EMBED_TOOL)
+        add_subdirectory(tool)
+    endif()
+endfunction()
@@ -1,3 +1,4 @@
 #pragma once
 
-#include "luax/State.hpp" // IWYU pragma: export
+#include "luax/State.hpp"     // IWYU pragma: export
+#include "luax/StatePool.hpp" // IWYU pragma: export
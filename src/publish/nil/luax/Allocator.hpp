@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace nil::luax
+{
+    /**
+     * allocator policy accepted by `State`.
+     * `reallocate` follows the `lua_Alloc` contract:
+     *  - `new_size == 0` frees `ptr` (if any) and returns `nullptr`
+     *  - otherwise returns a block of `new_size` bytes holding the first `old_size` bytes of `ptr`
+     *    (or `nullptr` on failure, which lua reports as a memory error)
+     *  - when `ptr` is `nullptr`, `old_size` is the lua type of the object being created
+     */
+    template <typename T>
+    concept is_allocator = requires(T& allocator, void* ptr, std::size_t size) {
+        { allocator.reallocate(ptr, size, size) } -> std::same_as<void*>;
+    };
+
+    /**
+     * Size-class pool allocator for lua states.
+     *
+     * most lua objects (strings, tables, closures, upvalues, small arrays) are small.
+     * blocks up to `max_pooled` bytes are rounded up to a multiple of `granularity`
+     * and served from a free list per size class, refilled from `chunk_size` chunks.
+     * bigger blocks go to `malloc`/`realloc`/`free`.
+     *
+     * memory of the pooled classes is only returned to the system when the allocator
+     * is destroyed, so it is expected to outlive the state using it.
+     * not thread safe, like the state itself (one allocator per state/thread).
+     */
+    class PoolAllocator final
+    {
+    public:
+        static constexpr std::size_t granularity = 16;
+        static constexpr std::size_t max_pooled = 512;
+        static constexpr std::size_t chunk_size = 64 * 1024;
+
+        PoolAllocator() = default;
+
+        PoolAllocator(PoolAllocator&&) = delete;
+        PoolAllocator(const PoolAllocator&) = delete;
+        PoolAllocator& operator=(PoolAllocator&&) = delete;
+        PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+        ~PoolAllocator() noexcept
+        {
+            while (chunks != nullptr)
+            {
+                std::free(std::exchange(chunks, chunks->next)); // NOLINT
+            }
+        }
+
+        void* reallocate(void* ptr, std::size_t old_size, std::size_t new_size) noexcept
+        {
+            if (ptr == nullptr)
+            {
+                return new_size == 0 ? nullptr : allocate(new_size);
+            }
+            if (new_size == 0)
+            {
+                deallocate(ptr, old_size);
+                return nullptr;
+            }
+
+            const auto old_class = size_class(old_size);
+            const auto new_class = size_class(new_size);
+            if (old_class == new_class && old_class < class_count)
+            {
+                return ptr;
+            }
+            if (old_class == class_count && new_class == class_count)
+            {
+                return std::realloc(ptr, new_size); // NOLINT
+            }
+
+            auto* moved = allocate(new_size);
+            if (moved != nullptr)
+            {
+                std::memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+                deallocate(ptr, old_size);
+            }
+            return moved;
+        }
+
+    private:
+        static constexpr std::size_t class_count = max_pooled / granularity;
+
+        struct Block
+        {
+            Block* next;
+        };
+
+        struct alignas(std::max_align_t) Chunk
+        {
+            Chunk* next;
+        };
+
+        std::array<Block*, class_count> free_lists = {};
+        Chunk* chunks = nullptr;
+        std::byte* cursor = nullptr;
+        std::byte* end = nullptr;
+
+        /**
+         * `class_count` for blocks that are not pooled.
+         */
+        static std::size_t size_class(std::size_t size)
+        {
+            return size > max_pooled ? class_count : (size - 1) / granularity;
+        }
+
+        void* allocate(std::size_t size)
+        {
+            const auto index = size_class(size);
+            if (index == class_count)
+            {
+                return std::malloc(size); // NOLINT
+            }
+
+            if (auto* block = free_lists[index]; block != nullptr)
+            {
+                free_lists[index] = block->next;
+                return block;
+            }
+
+            const auto rounded = (index + 1) * granularity;
+            if (std::size_t(end - cursor) < rounded)
+            {
+                refill();
+                if (cursor == nullptr)
+                {
+                    return nullptr;
+                }
+            }
+            return std::exchange(cursor, cursor + rounded);
+        }
+
+        void deallocate(void* ptr, std::size_t size)
+        {
+            const auto index = size_class(size);
+            if (index == class_count)
+            {
+                std::free(ptr); // NOLINT
+                return;
+            }
+            auto* block = static_cast<Block*>(ptr);
+            block->next = free_lists[index];
+            free_lists[index] = block;
+        }
+
+        /**
+         * the tail of the current chunk is given to the free list that fits it.
+         */
+        void refill()
+        {
+            if (const auto remaining = std::size_t(end - cursor); remaining >= granularity)
+            {
+                deallocate(cursor, remaining - remaining % granularity);
+            }
+
+            auto* chunk = static_cast<Chunk*>(std::malloc(chunk_size)); // NOLINT
+            if (chunk == nullptr)
+            {
+                cursor = nullptr;
+                end = nullptr;
+                return;
+            }
+            chunk->next = chunks;
+            chunks = chunk;
+            cursor = reinterpret_cast<std::byte*>(chunk) + sizeof(Chunk); // NOLINT
+            end = reinterpret_cast<std::byte*>(chunk) + chunk_size;       // NOLINT
+        }
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "TypeDef.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * Contiguous C++ elements exposed to lua as a userdata, without copying them to a table.
+     *
+     * scripts read and write the buffer directly: `view[i]` (1 based, nil when out of range),
+     * `view[i] = v` (checked against the bounds), `#view`, `ipairs(view)` and `pairs(view)`.
+     * `ArrayView<const T>` is read only. user type elements are accessed by reference.
+     *
+     * a view either borrows its elements (the memory has to outlive every lua reference to
+     * the view) or owns them (`owned`), in which case they live as long as the view.
+     */
+    template <typename T>
+    class ArrayView final
+    {
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+
+        ArrayView() = default;
+
+        explicit ArrayView(std::span<T> init_elements)
+            : elements(init_elements)
+        {
+        }
+
+        static ArrayView owned(std::vector<value_type> values)
+        {
+            auto view = ArrayView();
+            view.storage = std::make_shared<std::vector<value_type>>(std::move(values));
+            view.elements = std::span<T>(view.storage->data(), view.storage->size());
+            return view;
+        }
+
+        T& operator[](std::size_t index) const
+        {
+            return elements[index];
+        }
+
+        std::size_t size() const
+        {
+            return elements.size();
+        }
+
+        std::span<T> span() const
+        {
+            return elements;
+        }
+
+    private:
+        std::span<T> elements;
+        // shared so that copies (lua keeps one) see the same elements
+        std::shared_ptr<std::vector<value_type>> storage;
+    };
+
+    template <typename T>
+    struct Meta<ArrayView<T>>
+    {
+        static constexpr bool indexed = true;
+    };
+}
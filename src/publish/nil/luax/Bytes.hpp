@@ -0,0 +1,173 @@
+#pragma once
+
+#include "Container.hpp"
+#include "TypeDef.hpp"
+#include "UserType.hpp"
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace nil::luax
+{
+    /**
+     * Read only bytes passed to lua as a userdata instead of a lua string,
+     * so that large payloads are neither copied nor hashed.
+     *
+     * from lua:
+     *  - `#bytes` and `bytes[i]` (byte value, 1 based, nil when out of range)
+     *  - `bytes:sub(i [, j])` like `string.sub`, only the slice becomes a lua string
+     *  - `bytes:find(text [, init])` plain search, returns the 1 based position or nil
+     *
+     * accepted wherever a `std::span<const std::byte>` is expected.
+     * like `ArrayView`, the bytes are either borrowed (the memory has to outlive every lua
+     * reference) or owned (`owned`).
+     */
+    class Bytes final
+    {
+    public:
+        Bytes() = default;
+
+        explicit Bytes(std::span<const std::byte> init_data)
+            : data(init_data)
+        {
+        }
+
+        template <std::ranges::contiguous_range C>
+            requires(sizeof(std::ranges::range_value_t<C>) == 1)
+        static Bytes owned(C content)
+        {
+            auto owner = std::make_shared<C>(std::move(content));
+            auto bytes = Bytes(std::as_bytes(std::span(std::as_const(*owner))));
+            bytes.owner = std::move(owner);
+            return bytes;
+        }
+
+        const unsigned char& operator[](std::size_t index) const
+        {
+            return reinterpret_cast<const unsigned char*>(data.data())[index]; // NOLINT
+        }
+
+        std::size_t size() const
+        {
+            return data.size();
+        }
+
+        std::span<const std::byte> span() const
+        {
+            return data;
+        }
+
+        std::string_view view() const
+        {
+            return {reinterpret_cast<const char*>(data.data()), data.size()}; // NOLINT
+        }
+
+        std::string sub(lua_Integer i, std::optional<lua_Integer> j) const
+        {
+            const auto size = lua_Integer(data.size());
+            const auto first = std::max(relative(i, size), lua_Integer(1));
+            const auto last = std::min(relative(j.value_or(-1), size), size);
+            if (first > last)
+            {
+                return {};
+            }
+            const auto count = std::size_t(last - first + 1);
+            return std::string(view().substr(std::size_t(first - 1), count));
+        }
+
+        std::optional<lua_Integer> find(std::string_view text, std::optional<lua_Integer> init)
+            const
+        {
+            const auto size = lua_Integer(data.size());
+            const auto first = std::max(relative(init.value_or(1), size), lua_Integer(1));
+            if (first > size + 1)
+            {
+                return std::nullopt;
+            }
+            const auto position = view().find(text, std::size_t(first - 1));
+            if (position == std::string_view::npos)
+            {
+                return std::nullopt;
+            }
+            return lua_Integer(position + 1);
+        }
+
+    private:
+        std::span<const std::byte> data;
+        std::shared_ptr<const void> owner;
+
+        /**
+         * negative positions count from the end, like the string library.
+         */
+        static lua_Integer relative(lua_Integer position, lua_Integer size)
+        {
+            return position >= 0 ? position : std::max(size + position + 1, lua_Integer(0));
+        }
+    };
+
+    template <>
+    struct Meta<Bytes>
+    {
+        static constexpr bool indexed = true;
+
+        using Members = List<Method<"sub", &Bytes::sub>, Method<"find", &Bytes::find>>;
+    };
+
+    template <>
+    constexpr std::uint32_t accepted_types<std::span<const std::byte>>
+        = (1u << LUA_TSTRING) | (1u << LUA_TUSERDATA);
+
+    /**
+     * lua strings and `Bytes`, without copy.
+     * only valid while the value is (for arguments: during the call).
+     */
+    template <>
+    struct TypeDef<std::span<const std::byte>> final
+    {
+        static bool check(lua_State* state, int index)
+        {
+            return lua_type(state, index) == LUA_TSTRING
+                || UserType<Bytes>::to(state, index) != nullptr;
+        }
+
+        static std::span<const std::byte> value(lua_State* state, int index)
+        {
+            if (lua_type(state, index) == LUA_TSTRING)
+            {
+                std::size_t size = 0;
+                const char* data = lua_tolstring(state, index, &size);
+                return std::as_bytes(std::span(data, size));
+            }
+            if (const auto* bytes = UserType<Bytes>::to(state, index); bytes != nullptr)
+            {
+                return bytes->span();
+            }
+            throw_type_error(state, "bytes", lua_type(state, index));
+        }
+
+        /**
+         * copied to a lua string.
+         */
+        static void push(lua_State* state, std::span<const std::byte> value)
+        {
+            lua_pushlstring(
+                state,
+                reinterpret_cast<const char*>(value.data()), // NOLINT
+                value.size()
+            );
+        }
+    };
+}
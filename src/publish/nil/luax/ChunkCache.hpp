@@ -0,0 +1,318 @@
+#pragma once
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * On-disk cache of precompiled chunks (`lua_dump` output), opt-in per `State`.
+     *
+     * entries are named after a hash of the chunk name, the source and the lua version.
+     * each entry also stores the chunk name and the source it was compiled from and a
+     * checksum of the bytecode, all validated on read: an entry that does not match
+     * (hash collision, different version, truncated, corrupted) is treated as a miss and
+     * removed. lua itself validates the bytecode header (version, format, type sizes) on load.
+     *
+     * writes go to a temporary file (unique per process and thread) that is renamed,
+     * so concurrent readers never see partial entries. after a write, the oldest entries
+     * are evicted until the total size is within `max_size`.
+     *
+     * the cache is best effort: filesystem errors are ignored (the source is used instead).
+     * bytecode is not verified by lua, only use a directory that is trusted.
+     */
+    class ChunkCache final
+    {
+    public:
+        static constexpr std::uintmax_t default_max_size = 64ull * 1024ull * 1024ull;
+
+        explicit ChunkCache(
+            std::filesystem::path init_directory,
+            std::uintmax_t init_max_size = default_max_size
+        )
+            : directory(std::move(init_directory))
+            , max_size(init_max_size)
+        {
+            auto ec = std::error_code();
+            std::filesystem::create_directories(directory, ec);
+        }
+
+        ChunkCache(ChunkCache&&) = delete;
+        ChunkCache(const ChunkCache&) = delete;
+        ChunkCache& operator=(ChunkCache&&) = delete;
+        ChunkCache& operator=(const ChunkCache&) = delete;
+
+        ~ChunkCache() noexcept = default;
+
+        /**
+         * identifies a chunk, the views are expected to outlive the key.
+         */
+        struct Key
+        {
+            std::uint64_t hash;
+            std::string_view chunkname;
+            std::string_view source;
+        };
+
+        static Key key(std::string_view chunkname, std::string_view source)
+        {
+            auto hash = hash_fnv1a(chunkname, offset_basis);
+            hash = hash_fnv1a({"\0", 1}, hash);
+            hash = hash_fnv1a(source, hash);
+            const auto version = std::uint64_t(LUA_VERSION_NUM);
+            return {hash ^ (version << 48u), chunkname, source};
+        }
+
+        /**
+         * returns the bytecode stored for `key`, if any.
+         */
+        std::optional<std::string> read(const Key& key) const
+        {
+            const auto path = entry_path(key.hash);
+            auto ec = std::error_code();
+            const auto file_size = std::filesystem::file_size(path, ec);
+            auto file = std::ifstream(path, std::ios::binary);
+            if (ec || !file)
+            {
+                return std::nullopt;
+            }
+
+            auto header = Header();
+            file.read(reinterpret_cast<char*>(&header), sizeof(Header)); // NOLINT
+            if (!file || !header.matches(key) || header.total() != file_size)
+            {
+                file.close();
+                remove(path);
+                return std::nullopt;
+            }
+
+            // the hash only names the entry, the chunk it was compiled from has to match
+            auto origin = std::string(key.chunkname.size() + key.source.size(), '\0');
+            file.read(origin.data(), std::streamsize(origin.size()));
+            auto bytecode = std::string(header.size, '\0');
+            file.read(bytecode.data(), std::streamsize(header.size));
+            if (!file || file.peek() != std::ifstream::traits_type::eof()
+                || std::string_view(origin).substr(0, key.chunkname.size()) != key.chunkname
+                || std::string_view(origin).substr(key.chunkname.size()) != key.source
+                || hash_fnv1a(bytecode, offset_basis) != header.checksum)
+            {
+                file.close();
+                remove(path);
+                return std::nullopt;
+            }
+
+            // keeps recently used entries from being evicted first
+            const auto now = std::filesystem::file_time_type::clock::now();
+            std::filesystem::last_write_time(path, now, ec);
+            return bytecode;
+        }
+
+        void write(const Key& key, std::string_view bytecode)
+        {
+            const auto path = entry_path(key.hash);
+            auto temporary = path;
+            temporary += ".tmp" + temporary_suffix();
+            {
+                auto file = std::ofstream(temporary, std::ios::binary | std::ios::trunc);
+                const auto header = Header(key, bytecode, hash_fnv1a(bytecode, offset_basis));
+                file.write(reinterpret_cast<const char*>(&header), sizeof(Header)); // NOLINT
+                file.write(key.chunkname.data(), std::streamsize(key.chunkname.size()));
+                file.write(key.source.data(), std::streamsize(key.source.size()));
+                file.write(bytecode.data(), std::streamsize(bytecode.size()));
+                if (!file)
+                {
+                    file.close();
+                    remove(temporary);
+                    return;
+                }
+            }
+            auto ec = std::error_code();
+            std::filesystem::rename(temporary, path, ec);
+            if (ec)
+            {
+                remove(temporary);
+                return;
+            }
+            evict();
+        }
+
+        /**
+         * removes every entry.
+         */
+        void clear()
+        {
+            for (const auto& entry : entries())
+            {
+                remove(entry.path);
+            }
+        }
+
+        /**
+         * total size of the entries in bytes.
+         */
+        std::uintmax_t size() const
+        {
+            std::uintmax_t total = 0;
+            for (const auto& entry : entries())
+            {
+                total += entry.size;
+            }
+            return total;
+        }
+
+    private:
+        std::filesystem::path directory;
+        std::uintmax_t max_size;
+
+        static constexpr std::string_view extension = ".luac";
+        static constexpr std::uint64_t offset_basis = 0xCBF29CE484222325ull;
+        static constexpr std::uint64_t prime = 0x100000001B3ull;
+
+        struct Header
+        {
+            Header() = default;
+
+            Header(const Key& init_key, std::string_view bytecode, std::uint64_t init_checksum)
+                : key(init_key.hash)
+                , chunkname_size(init_key.chunkname.size())
+                , source_size(init_key.source.size())
+                , size(bytecode.size())
+                , checksum(init_checksum)
+            {
+            }
+
+            std::array<char, 8> magic = {'n', 'i', 'l', 'l', 'u', 'a', 'x', '\1'};
+            std::uint32_t version = LUA_VERSION_NUM;
+            std::uint32_t number_size = sizeof(lua_Number) | (sizeof(lua_Integer) << 8u);
+            std::uint64_t key = 0;
+            std::uint64_t chunkname_size = 0;
+            std::uint64_t source_size = 0;
+            /**
+             * of the bytecode, stored after the chunk name and the source.
+             */
+            std::uint64_t size = 0;
+            std::uint64_t checksum = 0;
+
+            bool matches(const Key& expected_key) const
+            {
+                const auto expected = Header();
+                return magic == expected.magic                         //
+                    && version == expected.version                     //
+                    && number_size == expected.number_size             //
+                    && key == expected_key.hash                        //
+                    && chunkname_size == expected_key.chunkname.size() //
+                    && source_size == expected_key.source.size();
+            }
+
+            std::uintmax_t total() const
+            {
+                return sizeof(Header) + chunkname_size + source_size + size;
+            }
+        };
+
+        struct Entry
+        {
+            std::filesystem::path path;
+            std::uintmax_t size;
+            std::filesystem::file_time_type time;
+        };
+
+        static std::uint64_t hash_fnv1a(std::string_view data, std::uint64_t hash)
+        {
+            for (auto c : data)
+            {
+                hash ^= static_cast<std::uint8_t>(c);
+                hash *= prime;
+            }
+            return hash;
+        }
+
+        /**
+         * unique per process and thread, so that writers sharing the directory never
+         * write to the same temporary file.
+         */
+        static std::string temporary_suffix()
+        {
+            thread_local const auto suffix = std::to_string(std::random_device()())
+                + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+            return suffix;
+        }
+
+        std::filesystem::path entry_path(std::uint64_t key) const
+        {
+            constexpr std::string_view digits = "0123456789abcdef";
+            auto name = std::string(16, '0');
+            for (auto i = name.rbegin(); i != name.rend(); ++i, key >>= 4u)
+            {
+                *i = digits[key & 0xFu];
+            }
+            return directory / (name + std::string(extension));
+        }
+
+        std::vector<Entry> entries() const
+        {
+            auto result = std::vector<Entry>();
+            auto ec = std::error_code();
+            for (const auto& entry : std::filesystem::directory_iterator(directory, ec))
+            {
+                if (entry.path().extension() != extension)
+                {
+                    continue;
+                }
+                const auto size = entry.file_size(ec);
+                const auto time = entry.last_write_time(ec);
+                if (!ec)
+                {
+                    result.push_back({entry.path(), size, time});
+                }
+            }
+            return result;
+        }
+
+        void evict()
+        {
+            auto all = entries();
+            std::uintmax_t total = 0;
+            for (const auto& entry : all)
+            {
+                total += entry.size;
+            }
+            if (total <= max_size)
+            {
+                return;
+            }
+            std::sort(
+                all.begin(),
+                all.end(),
+                [](const Entry& l, const Entry& r) { return l.time < r.time; }
+            );
+            for (auto it = all.begin(); it != all.end() && total > max_size; ++it)
+            {
+                remove(it->path);
+                total -= it->size;
+            }
+        }
+
+        static void remove(const std::filesystem::path& path)
+        {
+            auto ec = std::error_code();
+            std::filesystem::remove(path, ec);
+        }
+    };
+}
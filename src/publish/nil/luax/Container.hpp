@@ -0,0 +1,459 @@
+#pragma once
+
+#include "Overload.hpp"
+#include "Ref.hpp"
+#include "TypeDef.hpp"
+#include "error.hpp"
+
+#include <nil/xalt/checks.hpp>
+#include <nil/xalt/str_name.hpp>
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * standard containers, copied from/to tables:
+ *  - `std::vector`, `std::array`     - sequence `{v1, v2, ...}`
+ *  - `std::pair`                     - sequence `{first, second}`
+ *  - `std::map`, `std::unordered_map` - `{[k] = v, ...}`
+ *  - `std::optional`                 - nil or the value
+ *  - `std::variant`                  - the first alternative that accepts the value
+ *
+ * tables are created with their exact size and accessed with raw gets/sets,
+ * metamethods are ignored.
+ *
+ * elements, keys and values are copied: views (`std::string_view`, `const char*`,
+ * `std::span<const std::byte>`) are rejected at compile time since they would point to
+ * values that are popped (a number is converted to a string that nothing anchors).
+ */
+
+namespace nil::luax
+{
+    template <typename T>
+        requires(is_container_type<T>                         //
+                 && !xalt::is_of_template_v<T, std::optional> //
+                 && !xalt::is_of_template_v<T, std::variant>)
+    constexpr std::uint32_t accepted_types<T> = 1u << LUA_TTABLE;
+
+    template <typename T>
+    constexpr std::uint32_t accepted_types<std::optional<T>>
+        = (1u << LUA_TNIL) | accepted_types<std::remove_cvref_t<T>>;
+
+    template <typename T>
+    concept is_view_type = std::is_same_v<T, std::string_view> //
+        || std::is_same_v<T, const char*>                      //
+        || std::is_same_v<T, std::span<const std::byte>>;
+
+    struct TableCommon final
+    {
+        /**
+         * checks the value at the top of the stack and pops it.
+         */
+        template <typename T>
+        static bool pop_check(lua_State* state)
+        {
+            const auto valid = TypeDef<T>::check(state, -1);
+            lua_pop(state, 1);
+            return valid;
+        }
+
+        /**
+         * reads the value at the top of the stack and pops it (also when it throws).
+         */
+        template <typename T>
+        static T pop_value(lua_State* state)
+        {
+            static_assert(!is_view_type<T>, "container elements are copied, use std::string");
+            try
+            {
+                T value = TypeDef<T>::value(state, -1);
+                lua_pop(state, 1);
+                return value;
+            }
+            catch (...)
+            {
+                lua_pop(state, 1);
+                throw;
+            }
+        }
+
+        /**
+         * reads the element `i` (1 based) of the table at `index` (absolute).
+         */
+        template <typename T>
+        static T element(lua_State* state, int index, lua_Integer i)
+        {
+            lua_rawgeti(state, index, i);
+            return pop_value<T>(state);
+        }
+
+        template <typename T>
+        static bool check_element(lua_State* state, int index, lua_Integer i)
+        {
+            lua_rawgeti(state, index, i);
+            return pop_check<T>(state);
+        }
+
+        template <typename T>
+        static void set_element(lua_State* state, lua_Integer i, const T& value)
+        {
+            TypeDef<T>::push(state, value);
+            lua_rawseti(state, -2, i);
+        }
+
+        /**
+         * for `key, value` of the table at `index` (absolute), stops at the first
+         * `fn(state)` returning false. the key is at -2 and the value at -1 while
+         * `fn` runs, both are left as they are.
+         */
+        template <typename F>
+        static bool for_each(lua_State* state, int index, F&& fn)
+        {
+            lua_pushnil(state);
+            while (lua_next(state, index) != 0)
+            {
+                bool proceed = false;
+                try
+                {
+                    proceed = fn(state);
+                }
+                catch (...)
+                {
+                    lua_pop(state, 2);
+                    throw;
+                }
+                lua_pop(state, 1);
+                if (!proceed)
+                {
+                    lua_pop(state, 1);
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static void check_table(lua_State* state, int index, const char* expected)
+        {
+            if (!lua_istable(state, index))
+            {
+                throw_type_error(state, expected, lua_type(state, index));
+            }
+        }
+    };
+
+    template <typename T>
+        requires(xalt::is_of_template_v<T, std::vector>)
+    struct TypeDef<T> final
+    {
+        using value_type = typename T::value_type;
+
+        static bool check(lua_State* state, int index)
+        {
+            if (!lua_istable(state, index))
+            {
+                return false;
+            }
+            index = lua_absindex(state, index);
+            const auto size = lua_Integer(lua_rawlen(state, index));
+            for (lua_Integer i = 1; i <= size; ++i)
+            {
+                if (!TableCommon::check_element<value_type>(state, index, i))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static T value(lua_State* state, int index)
+        {
+            TableCommon::check_table(state, index, xalt::str_name_v<T>);
+            index = lua_absindex(state, index);
+            const auto size = lua_Integer(lua_rawlen(state, index));
+            auto result = T();
+            result.reserve(std::size_t(size));
+            for (lua_Integer i = 1; i <= size; ++i)
+            {
+                result.push_back(TableCommon::element<value_type>(state, index, i));
+            }
+            return result;
+        }
+
+        static void push(lua_State* state, const T& value)
+        {
+            lua_createtable(state, int(value.size()), 0);
+            lua_Integer i = 0;
+            for (const value_type& item : value)
+            {
+                TableCommon::set_element<value_type>(state, ++i, item);
+            }
+        }
+
+        static auto pull(const Ref& ref)
+        {
+            return TypeDefCommon<T>::pull(ref);
+        }
+    };
+
+    template <typename T>
+        requires(is_std_array<T>::value)
+    struct TypeDef<T> final
+    {
+        using value_type = typename T::value_type;
+        static constexpr auto size = lua_Integer(std::tuple_size_v<T>);
+
+        static bool check(lua_State* state, int index)
+        {
+            if (!lua_istable(state, index) || lua_Integer(lua_rawlen(state, index)) != size)
+            {
+                return false;
+            }
+            index = lua_absindex(state, index);
+            for (lua_Integer i = 1; i <= size; ++i)
+            {
+                if (!TableCommon::check_element<value_type>(state, index, i))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static T value(lua_State* state, int index)
+        {
+            TableCommon::check_table(state, index, xalt::str_name_v<T>);
+            if (const auto actual = lua_Integer(lua_rawlen(state, index)); actual != size)
+            {
+                throw std::invalid_argument(
+                    "Error: expected [" + std::to_string(size) + "] elements, got ["
+                    + std::to_string(actual) + "]"
+                );
+            }
+            index = lua_absindex(state, index);
+            auto result = T();
+            for (lua_Integer i = 1; i <= size; ++i)
+            {
+                result[std::size_t(i - 1)] = TableCommon::element<value_type>(state, index, i);
+            }
+            return result;
+        }
+
+        static void push(lua_State* state, const T& value)
+        {
+            lua_createtable(state, int(size), 0);
+            for (lua_Integer i = 1; i <= size; ++i)
+            {
+                TableCommon::set_element<value_type>(state, i, value[std::size_t(i - 1)]);
+            }
+        }
+
+        static auto pull(const Ref& ref)
+        {
+            return TypeDefCommon<T>::pull(ref);
+        }
+    };
+
+    template <typename T>
+        requires(xalt::is_of_template_v<T, std::pair>)
+    struct TypeDef<T> final
+    {
+        using first_type = std::remove_cvref_t<typename T::first_type>;
+        using second_type = std::remove_cvref_t<typename T::second_type>;
+
+        static bool check(lua_State* state, int index)
+        {
+            if (!lua_istable(state, index))
+            {
+                return false;
+            }
+            index = lua_absindex(state, index);
+            return TableCommon::check_element<first_type>(state, index, 1)
+                && TableCommon::check_element<second_type>(state, index, 2);
+        }
+
+        static T value(lua_State* state, int index)
+        {
+            TableCommon::check_table(state, index, xalt::str_name_v<T>);
+            index = lua_absindex(state, index);
+            auto first = TableCommon::element<first_type>(state, index, 1);
+            return T(std::move(first), TableCommon::element<second_type>(state, index, 2));
+        }
+
+        static void push(lua_State* state, const T& value)
+        {
+            lua_createtable(state, 2, 0);
+            TableCommon::set_element<first_type>(state, 1, value.first);
+            TableCommon::set_element<second_type>(state, 2, value.second);
+        }
+
+        static auto pull(const Ref& ref)
+        {
+            return TypeDefCommon<T>::pull(ref);
+        }
+    };
+
+    template <typename T>
+        requires(xalt::is_of_template_v<T, std::map>
+                 || xalt::is_of_template_v<T, std::unordered_map>)
+    struct TypeDef<T> final
+    {
+        using key_type = typename T::key_type;
+        using mapped_type = typename T::mapped_type;
+
+        static bool check(lua_State* state, int index)
+        {
+            if (!lua_istable(state, index))
+            {
+                return false;
+            }
+            return TableCommon::for_each(
+                state,
+                lua_absindex(state, index),
+                [](lua_State* ss)
+                {
+                    // string keys would be converted in place by lua_tostring
+                    lua_pushvalue(ss, -2);
+                    return TableCommon::pop_check<key_type>(ss)
+                        && TypeDef<mapped_type>::check(ss, -1);
+                }
+            );
+        }
+
+        static T value(lua_State* state, int index)
+        {
+            static_assert(!is_view_type<mapped_type>, "map values are copied, use std::string");
+            TableCommon::check_table(state, index, xalt::str_name_v<T>);
+            auto result = T();
+            TableCommon::for_each(
+                state,
+                lua_absindex(state, index),
+                [&result](lua_State* ss)
+                {
+                    lua_pushvalue(ss, -2);
+                    auto key = TableCommon::pop_value<key_type>(ss);
+                    result.insert_or_assign(
+                        std::move(key),
+                        mapped_type(TypeDef<mapped_type>::value(ss, -1))
+                    );
+                    return true;
+                }
+            );
+            return result;
+        }
+
+        static void push(lua_State* state, const T& value)
+        {
+            lua_createtable(state, 0, int(value.size()));
+            for (const auto& [key, item] : value)
+            {
+                TypeDef<key_type>::push(state, key);
+                TypeDef<mapped_type>::push(state, item);
+                lua_rawset(state, -3);
+            }
+        }
+
+        static auto pull(const Ref& ref)
+        {
+            return TypeDefCommon<T>::pull(ref);
+        }
+    };
+
+    template <typename T>
+        requires(xalt::is_of_template_v<T, std::optional>)
+    struct TypeDef<T> final
+    {
+        using value_type = typename T::value_type;
+
+        static bool check(lua_State* state, int index)
+        {
+            return lua_isnoneornil(state, index) || TypeDef<value_type>::check(state, index);
+        }
+
+        static T value(lua_State* state, int index)
+        {
+            if (lua_isnoneornil(state, index))
+            {
+                return std::nullopt;
+            }
+            return T(TypeDef<value_type>::value(state, index));
+        }
+
+        static void push(lua_State* state, const T& value)
+        {
+            if (value.has_value())
+            {
+                TypeDef<value_type>::push(state, *value);
+            }
+            else
+            {
+                lua_pushnil(state);
+            }
+        }
+
+        static auto pull(const Ref& ref)
+        {
+            return TypeDefCommon<T>::pull(ref);
+        }
+    };
+
+    template <typename... V>
+    struct TypeDef<std::variant<V...>> final
+    {
+        using type = std::variant<V...>;
+
+        static bool check(lua_State* state, int index)
+        {
+            return (false || ... || TypeDef<V>::check(state, index));
+        }
+
+        static type value(lua_State* state, int index)
+        {
+            auto result = std::optional<type>();
+            (void)(false || ... || read<V>(state, index, result));
+            if (!result.has_value())
+            {
+                throw_type_error(state, xalt::str_name_v<type>, lua_type(state, index));
+            }
+            return std::move(*result);
+        }
+
+        static void push(lua_State* state, const type& value)
+        {
+            std::visit(
+                [state]<typename A>(const A& alternative) { TypeDef<A>::push(state, alternative); },
+                value
+            );
+        }
+
+        static auto pull(const Ref& ref)
+        {
+            return TypeDefCommon<type>::pull(ref);
+        }
+
+    private:
+        template <typename A>
+        static bool read(lua_State* state, int index, std::optional<type>& result)
+        {
+            if (!TypeDef<A>::check(state, index))
+            {
+                return false;
+            }
+            result.emplace(std::in_place_type<A>, TypeDef<A>::value(state, index));
+            return true;
+        }
+    };
+}
@@ -0,0 +1,646 @@
+#pragma once
+
+#include "Embedded.hpp"
+#include "Gc.hpp"
+#include "Instrumentation.hpp"
+#include "Profiler.hpp"
+
+extern "C"
+{
+#include <lauxlib.h>
+#include <lua.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * Metatables registered per C++ type.
+     *
+     * Every C++ type gets a process wide index the first time it is used.
+     * The index is used as the slot in this registry where the lua registry
+     * reference of the metatable is cached, making a push a single `lua_rawgeti`.
+     */
+    class TypeRegistry final
+    {
+    public:
+        /**
+         * pushes the metatable of T.
+         * returns false (and pushes nothing) if T has no registered metatable.
+         */
+        template <typename T>
+        bool push_metatable(lua_State* state) const
+        {
+            const auto index = type_index<T>();
+            if (index >= slots.size() || slots[index].ref == LUA_NOREF)
+            {
+                return false;
+            }
+            lua_rawgeti(state, LUA_REGISTRYINDEX, slots[index].ref);
+            return true;
+        }
+
+        /**
+         * registers the table at the top of the stack as the metatable of T.
+         * the table is left on the stack.
+         */
+        template <typename T>
+        void set_metatable(lua_State* state)
+        {
+            const auto index = type_index<T>();
+            if (index >= slots.size())
+            {
+                slots.resize(index + 1);
+            }
+            lua_pushvalue(state, -1);
+            slots[index].ref = luaL_ref(state, LUA_REGISTRYINDEX);
+            slots[index].ref_cache = LUA_NOREF;
+        }
+
+        template <typename T>
+        bool has_ref_cache() const
+        {
+            const auto index = type_index<T>();
+            return index < slots.size() && slots[index].ref_cache != LUA_NOREF;
+        }
+
+        /**
+         * pushes a weak valued table owned by T's slot, created on first use.
+         * used to reuse the userdata created for references of T.
+         * T is expected to have a registered metatable.
+         */
+        template <typename T>
+        void push_ref_cache(lua_State* state)
+        {
+            auto& slot = slots[type_index<T>()];
+            if (slot.ref_cache != LUA_NOREF)
+            {
+                lua_rawgeti(state, LUA_REGISTRYINDEX, slot.ref_cache);
+                return;
+            }
+            lua_newtable(state);
+            lua_createtable(state, 0, 1);
+            lua_pushstring(state, "v");
+            lua_setfield(state, -2, "__mode");
+            lua_setmetatable(state, -2);
+            lua_pushvalue(state, -1);
+            slot.ref_cache = luaL_ref(state, LUA_REGISTRYINDEX);
+        }
+
+        /**
+         * lua facing name of T (the global of its constructors), see `State::add_type`.
+         */
+        template <typename T>
+        void set_name(std::string_view name)
+        {
+            const auto index = type_index<T>();
+            if (index >= slots.size())
+            {
+                slots.resize(index + 1);
+            }
+            slots[index].name = name;
+        }
+
+        /**
+         * empty if T has no lua facing name.
+         */
+        template <typename T>
+        std::string_view name() const
+        {
+            const auto index = type_index<T>();
+            return index < slots.size() ? std::string_view(slots[index].name) : "";
+        }
+
+    private:
+        struct Slot
+        {
+            int ref = LUA_NOREF;
+            int ref_cache = LUA_NOREF;
+            std::string name;
+        };
+
+        std::vector<Slot> slots;
+
+        static std::size_t next_type_index()
+        {
+            static std::atomic<std::size_t> next = 0;
+            return next++;
+        }
+
+        template <typename T>
+        static std::size_t type_index()
+        {
+            static const std::size_t index = next_type_index();
+            return index;
+        }
+    };
+
+    /**
+     * Registry slots used by `Ref`, with a reference count per slot.
+     *
+     * Released slots are kept in a free list and reused with a single `lua_rawseti`
+     * instead of going through `luaL_unref`/`luaL_ref`.
+     * A released slot holds `false` (not `nil`) so that the registry stays a proper sequence.
+     *
+     * counting is not atomic.
+     * like the lua state itself, it is not meant to be shared across threads.
+     */
+    class RefPool final
+    {
+    public:
+        /**
+         * pops the value at the top of the stack and stores it in a slot.
+         * `nil` is not stored and gets `LUA_REFNIL`.
+         */
+        int acquire(lua_State* state)
+        {
+            if (lua_isnil(state, -1))
+            {
+                lua_pop(state, 1);
+                return LUA_REFNIL;
+            }
+            if (free_slots.empty())
+            {
+                const auto ref = luaL_ref(state, LUA_REGISTRYINDEX);
+                if (std::size_t(ref) >= counts.size())
+                {
+                    counts.resize(std::size_t(ref) + 1, 0);
+                }
+                counts[std::size_t(ref)] = 1;
+                return ref;
+            }
+            const auto ref = free_slots.back();
+            free_slots.pop_back();
+            lua_rawseti(state, LUA_REGISTRYINDEX, ref);
+            counts[std::size_t(ref)] = 1;
+            return ref;
+        }
+
+        /**
+         * `ref` is expected to be a slot returned by `acquire` (not `LUA_REFNIL`).
+         */
+        void retain(int ref)
+        {
+            ++counts[std::size_t(ref)];
+        }
+
+        void release(lua_State* state, int ref)
+        {
+            if (--counts[std::size_t(ref)] == 0)
+            {
+                lua_pushboolean(state, 0);
+                lua_rawseti(state, LUA_REGISTRYINDEX, ref);
+                free_slots.push_back(ref);
+            }
+        }
+
+    private:
+        std::vector<std::uint32_t> counts;
+        std::vector<int> free_slots;
+    };
+
+    /**
+     * memory used by a state (see `State::memory`), in bytes.
+     */
+    struct MemoryStats
+    {
+        std::size_t current = 0;
+        std::size_t peak = 0;
+        /**
+         * number of allocations and growing reallocations.
+         */
+        std::size_t allocations = 0;
+        /**
+         * 0 when unlimited.
+         */
+        std::size_t limit = 0;
+    };
+
+    /**
+     * Accounting layer installed between a state and its allocator.
+     *
+     * an allocation that would exceed `limit` fails, which lua turns into a memory error
+     * (after a full collection and a retry).
+     *
+     * the limit is only enforced during protected calls (see `Scope`), where the error is
+     * reported to the caller. anywhere else (the host pushing values, creating references or
+     * registering bindings) lua could only panic, so these allocations are accounted for
+     * but never refused.
+     */
+    class MemoryAccount final
+    {
+    public:
+        /**
+         * enforces the limit while alive.
+         */
+        class Scope final
+        {
+        public:
+            explicit Scope(MemoryAccount& init_account)
+                : account(init_account)
+            {
+                ++account.enforced;
+            }
+
+            ~Scope() noexcept
+            {
+                --account.enforced;
+            }
+
+            Scope(Scope&&) = delete;
+            Scope(const Scope&) = delete;
+            Scope& operator=(Scope&&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            MemoryAccount& account;
+        };
+
+        /**
+         * wraps the allocator of the state.
+         * memory already in use (the state itself) is taken from the collector.
+         */
+        void install(lua_State* state)
+        {
+            alloc = lua_getallocf(state, &ud);
+            stats.current = std::size_t(lua_gc(state, LUA_GCCOUNT)) * 1024u
+                + std::size_t(lua_gc(state, LUA_GCCOUNTB));
+            stats.peak = stats.current;
+            lua_setallocf(state, &MemoryAccount::reallocate, this);
+        }
+
+        void set_limit(std::size_t limit)
+        {
+            stats.limit = limit;
+        }
+
+        const MemoryStats& get() const
+        {
+            return stats;
+        }
+
+    private:
+        lua_Alloc alloc = nullptr;
+        void* ud = nullptr;
+        MemoryStats stats;
+        /**
+         * depth of the running protected calls.
+         */
+        int enforced = 0;
+
+        static void* reallocate(void* self, void* ptr, std::size_t old_size, std::size_t new_size)
+        {
+            auto& account = *static_cast<MemoryAccount*>(self);
+            auto& stats = account.stats;
+            // when ptr is null, old_size is the type of the new object
+            const auto previous = ptr == nullptr ? 0 : old_size;
+            if (new_size > previous)
+            {
+                const auto growth = new_size - previous;
+                if (account.enforced > 0 && stats.limit != 0
+                    && stats.current + growth > stats.limit)
+                {
+                    return nullptr;
+                }
+                auto* result = account.alloc(account.ud, ptr, old_size, new_size);
+                if (result != nullptr)
+                {
+                    stats.current += growth;
+                    stats.peak = std::max(stats.peak, stats.current);
+                    ++stats.allocations;
+                }
+                return result;
+            }
+            auto* result = account.alloc(account.ud, ptr, old_size, new_size);
+            // a failed shrink keeps the block
+            if (result != nullptr || new_size == 0)
+            {
+                stats.current -= previous - new_size;
+            }
+            return result;
+        }
+    };
+
+    /**
+     * limits of execution for a state, 0 means no limit.
+     */
+    struct Budget
+    {
+        /**
+         * number of lua vm instructions.
+         */
+        std::uint64_t instructions = 0;
+        /**
+         * wall clock time.
+         */
+        std::chrono::nanoseconds duration = {};
+    };
+
+    /**
+     * Instruction count and deadline enforcing a `Budget` (see `State::set_budget`).
+     *
+     * checked by the count hook of the state every `check_interval` instructions
+     * (less when the remaining instruction count is smaller).
+     * once exceeded, it is checked on every instruction and keeps failing,
+     * so a script can not keep running by catching the error with `pcall`.
+     */
+    class BudgetHook final
+    {
+    public:
+        static constexpr std::uint64_t check_interval = 1000;
+
+        void arm(const Budget& init_budget)
+        {
+            budget = init_budget;
+            used = 0;
+            is_exceeded = false;
+            raised = nullptr;
+            deadline = clock::now() + budget.duration;
+        }
+
+        void disarm()
+        {
+            arm({});
+        }
+
+        bool exceeded() const
+        {
+            return is_exceeded;
+        }
+
+        /**
+         * records the error object (`lua_topointer`) about to be raised by the hook.
+         */
+        void raising(const void* error)
+        {
+            raised = error;
+        }
+
+        /**
+         * true when `error` (`lua_topointer` of an error object) is the last error raised
+         * by the hook, which is then forgotten. other errors happening while the budget is
+         * exceeded (syntax, type or memory errors) are not budget errors.
+         */
+        bool raised_by_hook(const void* error)
+        {
+            return error != nullptr && std::exchange(raised, nullptr) == error;
+        }
+
+        /**
+         * instructions executed since the budget was set, counted at each check.
+         */
+        std::uint64_t instructions() const
+        {
+            return used;
+        }
+
+        /**
+         * instructions until the next check, 0 when there is no budget.
+         */
+        std::uint64_t due() const
+        {
+            if (is_exceeded)
+            {
+                return 1;
+            }
+            if (budget.instructions != 0)
+            {
+                return std::min(check_interval, budget.instructions - used);
+            }
+            return budget.duration.count() == 0 ? 0 : check_interval;
+        }
+
+        /**
+         * called by the hook after `count` instructions.
+         * returns true when the budget is exceeded.
+         */
+        bool tick(std::uint64_t count)
+        {
+            if (!is_exceeded)
+            {
+                used += count;
+                is_exceeded = (budget.instructions != 0 && used >= budget.instructions)
+                    || (budget.duration.count() != 0 && clock::now() >= deadline);
+            }
+            return is_exceeded;
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        Budget budget;
+        clock::time_point deadline;
+        std::uint64_t used = 0;
+        bool is_exceeded = false;
+        const void* raised = nullptr;
+    };
+
+    enum class ThreadStatus
+    {
+        running,
+        /**
+         * suspended by a binding returning an `Async`, resumed when it completes.
+         */
+        waiting,
+        done,
+        failed
+    };
+
+    /**
+     * a lua thread started with `State::spawn`.
+     */
+    struct ThreadState
+    {
+        ThreadStatus status = ThreadStatus::running;
+        /**
+         * values returned by the thread, left at the top of its stack.
+         */
+        int results = 0;
+        std::string error;
+        /**
+         * c++ coroutines awaiting the end of the thread.
+         */
+        std::vector<std::coroutine_handle<>> waiters;
+        /**
+         * frame of the `Async` the thread is waiting on, owned by the thread.
+         */
+        std::coroutine_handle<> pending;
+    };
+
+    /**
+     * Threads started from c++ that have not finished yet.
+     * the registry keeps them alive (a registry reference each) until they do.
+     */
+    class ThreadRegistry final
+    {
+    public:
+        /**
+         * `thread` is expected at the top of the stack of `state`, it is popped.
+         */
+        std::shared_ptr<ThreadState> add(lua_State* state, lua_State* thread)
+        {
+            auto thread_state = std::make_shared<ThreadState>();
+            threads.emplace(thread, Entry{luaL_ref(state, LUA_REGISTRYINDEX), thread_state});
+            main_state = state;
+            return thread_state;
+        }
+
+        /**
+         * nullptr if `thread` was not started from c++ or is finished.
+         */
+        std::shared_ptr<ThreadState> find(lua_State* thread) const
+        {
+            const auto it = threads.find(thread);
+            return it == threads.end() ? nullptr : it->second.state;
+        }
+
+        void remove(lua_State* thread)
+        {
+            if (const auto it = threads.find(thread); it != threads.end())
+            {
+                luaL_unref(main_state, LUA_REGISTRYINDEX, it->second.ref);
+                threads.erase(it);
+            }
+        }
+
+        /**
+         * the state the threads are started from (never suspended).
+         */
+        lua_State* main() const
+        {
+            return main_state;
+        }
+
+        /**
+         * destroys the frames of the `Async` the unfinished threads are waiting on,
+         * before the state is closed. their awaiters are left suspended.
+         */
+        void close() noexcept
+        {
+            auto remaining = std::move(threads);
+            threads.clear();
+            for (auto& [thread, entry] : remaining)
+            {
+                entry.state->status = ThreadStatus::failed;
+                entry.state->error.clear();
+                if (auto pending = std::exchange(entry.state->pending, {}))
+                {
+                    pending.destroy();
+                }
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            int ref;
+            std::shared_ptr<ThreadState> state;
+        };
+
+        std::unordered_map<const lua_State*, Entry> threads;
+        lua_State* main_state = nullptr;
+    };
+
+    /**
+     * Data owned by `State` that the bindings need to reach from a `lua_State*`.
+     * A pointer to it is stored in the extra space of the lua state
+     * (and is inherited by every thread created from it).
+     */
+    class Context final
+    {
+    public:
+        Context() = default;
+
+        Context(Context&&) = delete;
+        Context(const Context&) = delete;
+        Context& operator=(Context&&) = delete;
+        Context& operator=(const Context&) = delete;
+
+        ~Context() noexcept = default;
+
+        /**
+         * installs the count hook shared by the budget and the profiler, with the smallest
+         * interval either needs (or removes it when neither is active).
+         */
+        void update_hook(lua_State* state)
+        {
+            auto count = budget.due();
+            if (const auto next = profiler.due(); next != 0)
+            {
+                count = count == 0 ? next : std::min(count, next);
+            }
+            hook_count = std::min(count, std::uint64_t(std::numeric_limits<int>::max()));
+            if (count == 0)
+            {
+                lua_sethook(state, nullptr, 0, 0);
+                return;
+            }
+            lua_sethook(state, &Context::hook, LUA_MASKCOUNT, int(hook_count));
+        }
+
+        static Context& from(lua_State* state)
+        {
+            return **static_cast<Context**>(lua_getextraspace(state));
+        }
+
+        void attach(lua_State* state)
+        {
+            *static_cast<Context**>(lua_getextraspace(state)) = this;
+        }
+
+        TypeRegistry types;
+        RefPool refs;
+        MemoryAccount memory;
+        BudgetHook budget;
+        Profiler profiler;
+        Instrumentation instrumentation;
+        /**
+         * counters of `State::gc_step` and collector mode.
+         */
+        GcStats gc;
+        std::vector<EmbeddedModule> embedded;
+        ThreadRegistry threads;
+
+    private:
+        std::uint64_t hook_count = 0;
+
+        static void hook(lua_State* state, lua_Debug* /* ar */)
+        {
+            auto& self = Context::from(state);
+            const auto count = self.hook_count;
+            self.profiler.tick(state, count);
+            const auto exceeded = self.budget.tick(count);
+            self.update_hook(state);
+            if (exceeded)
+            {
+                luaL_where(state, 1);
+                lua_pushliteral(state, "budget exceeded");
+                lua_concat(state, 2);
+                self.budget.raising(lua_topointer(state, -1));
+                lua_error(state);
+            }
+        }
+    };
+
+    /**
+     * `lua_pcall` with the memory limit of the state enforced (see `MemoryAccount`).
+     */
+    inline int protected_call(lua_State* state, int args, int results)
+    {
+        const auto scope = MemoryAccount::Scope(Context::from(state).memory);
+        return lua_pcall(state, args, results, 0);
+    }
+}
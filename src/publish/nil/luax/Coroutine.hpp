@@ -0,0 +1,509 @@
+#pragma once
+
+#include "Context.hpp"
+#include "Ref.hpp"
+#include "TypeDef.hpp"
+#include "error.hpp"
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace nil::luax
+{
+    /**
+     * marks the thread as failed, without throwing.
+     */
+    inline void fail_thread(ThreadState& thread_state, const char* message) noexcept
+    {
+        thread_state.status = ThreadStatus::failed;
+        try
+        {
+            thread_state.error = message;
+        }
+        catch (...)
+        {
+            thread_state.error.clear();
+        }
+    }
+
+    /**
+     * resumes a thread started with `State::spawn` with the `count` values at the top of its
+     * stack. once it is finished, the c++ coroutines awaiting it (if any) are resumed.
+     */
+    inline void resume_thread(lua_State* thread, int count)
+    {
+        auto& threads = Context::from(thread).threads;
+        const auto thread_state = threads.find(thread);
+        if (thread_state == nullptr)
+        {
+            return;
+        }
+
+        thread_state->status = ThreadStatus::running;
+        int results = 0;
+        const auto status = [&]()
+        {
+            auto& ctx = Context::from(thread);
+            // the budget (or profiler) may have been set since the thread was created
+            ctx.update_hook(thread);
+            const auto scope = MemoryAccount::Scope(ctx.memory);
+            return lua_resume(thread, nullptr, count, &results);
+        }();
+        if (status == LUA_YIELD && thread_state->status == ThreadStatus::waiting)
+        {
+            return;
+        }
+
+        if (status == LUA_YIELD)
+        {
+            lua_pop(thread, results);
+            fail_thread(
+                *thread_state,
+                "a thread started with spawn can only wait on async bindings"
+            );
+        }
+        else if (status == LUA_OK)
+        {
+            thread_state->status = ThreadStatus::done;
+            thread_state->results = results;
+        }
+        else
+        {
+            // converting a non string error object could raise outside of a protected call
+            fail_thread(
+                *thread_state,
+                lua_type(thread, -1) == LUA_TSTRING ? lua_tostring(thread, -1)
+                                                    : "(error object is not a string)"
+            );
+            lua_pop(thread, 1);
+        }
+        threads.remove(thread);
+        for (auto waiter : std::exchange(thread_state->waiters, {}))
+        {
+            waiter.resume();
+        }
+    }
+
+    template <typename R>
+    struct AsyncResult
+    {
+        std::optional<R> value;
+
+        void return_value(R result)
+        {
+            value.emplace(std::move(result));
+        }
+    };
+
+    template <>
+    struct AsyncResult<void>
+    {
+        std::optional<std::monostate> value;
+
+        void return_void()
+        {
+            value.emplace();
+        }
+    };
+
+    /**
+     * C++20 coroutine task.
+     *
+     * a binding returning an `Async` suspends the lua thread calling it until the coroutine
+     * completes, then the thread is resumed with its result (or error). such bindings can only
+     * be called from threads started with `State::spawn`.
+     *
+     * an `Async` can also `co_await` another `Async` or a `Coroutine` (a lua thread), and
+     * be driven directly with `start()`, `done()` and `result()`.
+     *
+     * the coroutine starts suspended (`start()` or `co_await` runs it).
+     * like the state itself, it is expected to be resumed on the thread owning the state.
+     */
+    template <typename R = void>
+    class [[nodiscard]] Async final
+    {
+    public:
+        struct promise_type;
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(handle_type handle) noexcept
+            {
+                auto& promise = handle.promise();
+                if (promise.continuation)
+                {
+                    return promise.continuation;
+                }
+                if (auto* thread = promise.thread)
+                {
+                    // nothing but the thread owns the coroutine once a binding returned it
+                    const auto count = transfer_result(thread, promise);
+                    if (const auto thread_state = Context::from(thread).threads.find(thread))
+                    {
+                        thread_state->pending = {};
+                    }
+                    handle.destroy();
+                    resume_thread(thread, count);
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept
+            {
+            }
+        };
+
+        struct promise_type: AsyncResult<R>
+        {
+            std::exception_ptr error;
+            std::coroutine_handle<> continuation;
+            /**
+             * the lua thread waiting for the result, when started by a binding.
+             */
+            lua_State* thread = nullptr;
+
+            Async get_return_object()
+            {
+                return Async(handle_type::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            FinalAwaiter final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception()
+            {
+                error = std::current_exception();
+            }
+        };
+
+        Async(Async&& other) noexcept
+            : handle(std::exchange(other.handle, nullptr))
+            , started(other.started)
+        {
+        }
+
+        Async& operator=(Async&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                handle = std::exchange(other.handle, nullptr);
+                started = other.started;
+            }
+            return *this;
+        }
+
+        Async(const Async&) = delete;
+        Async& operator=(const Async&) = delete;
+
+        ~Async() noexcept
+        {
+            reset();
+        }
+
+        /**
+         * runs the coroutine until it completes or suspends, only the first call does.
+         */
+        void start()
+        {
+            if (!std::exchange(started, true))
+            {
+                handle.resume();
+            }
+        }
+
+        bool done() const
+        {
+            return handle.done();
+        }
+
+        /**
+         * the returned value (moved out) or the exception thrown by the coroutine.
+         * expects `done()`.
+         */
+        R result()
+        {
+            return take(handle.promise());
+        }
+
+        auto operator co_await() noexcept
+        {
+            struct Awaiter
+            {
+                Async& self;
+
+                bool await_ready() const noexcept
+                {
+                    return self.started && self.done();
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+                {
+                    self.handle.promise().continuation = caller;
+                    self.started = true;
+                    return self.handle;
+                }
+
+                R await_resume()
+                {
+                    return self.result();
+                }
+            };
+
+            return Awaiter{*this};
+        }
+
+    private:
+        handle_type handle;
+        bool started = false;
+
+        explicit Async(handle_type init_handle)
+            : handle(init_handle)
+        {
+        }
+
+        void reset()
+        {
+            if (handle)
+            {
+                std::exchange(handle, nullptr).destroy();
+            }
+        }
+
+        static R take(promise_type& promise)
+        {
+            if (promise.error)
+            {
+                std::rethrow_exception(promise.error);
+            }
+            if constexpr (!std::is_void_v<R>)
+            {
+                return std::move(*promise.value);
+            }
+        }
+
+        /**
+         * pushes `true, result` or `false, message` onto the suspended `thread`
+         * (see `continue_async`) and returns the number of values.
+         *
+         * the values are created on the main state under `lua_pcall` and moved, so a memory
+         * error (or an exception thrown by a `TypeDef`) becomes `false, message`.
+         * when even that is not possible, nothing is pushed and the thread fails.
+         */
+        static int transfer_result(lua_State* thread, promise_type& promise) noexcept
+        {
+            auto* state = Context::from(thread).threads.main();
+            if (lua_checkstack(state, 2) == 0 || lua_checkstack(thread, 2) == 0)
+            {
+                return 0;
+            }
+            const auto top = lua_gettop(state);
+            lua_pushcfunction(state, &protect<&Async::push_result>);
+            lua_pushlightuserdata(state, &promise);
+            if (lua_pcall(state, 1, LUA_MULTRET, 0) != LUA_OK)
+            {
+                lua_pushboolean(thread, 0);
+                lua_xmove(state, thread, 1);
+                return 2;
+            }
+            const auto count = lua_gettop(state) - top;
+            lua_xmove(state, thread, count);
+            return count;
+        }
+
+        /**
+         * [1] - light userdata of the promise
+         */
+        static int push_result(lua_State* state)
+        {
+            auto& promise = *static_cast<promise_type*>(lua_touserdata(state, 1));
+            if (promise.error)
+            {
+                lua_pushboolean(state, 0);
+                try
+                {
+                    std::rethrow_exception(promise.error);
+                }
+                catch (const std::exception& e)
+                {
+                    auto what = std::string_view(e.what());
+                    if (what.starts_with("Error: "))
+                    {
+                        what.remove_prefix(7);
+                    }
+                    lua_pushlstring(state, what.data(), what.size());
+                }
+                catch (...)
+                {
+                    lua_pushliteral(state, "unknown error");
+                }
+                return 2;
+            }
+            lua_pushboolean(state, 1);
+            if constexpr (std::is_void_v<R>)
+            {
+                return 1;
+            }
+            else
+            {
+                TypeDef<R>::push(state, std::move(*promise.value));
+                return 2;
+            }
+        }
+
+        template <typename T>
+        friend int push_async(lua_State* state, Async<T> async);
+    };
+
+    /**
+     * result of a binding returning an `Async`: pushed right away when it completes without
+     * suspending, otherwise the calling thread yields (`yield_request`) until it does.
+     */
+    template <typename R>
+    int push_async(lua_State* state, Async<R> async)
+    {
+        const auto thread_state = Context::from(state).threads.find(state);
+        if (thread_state == nullptr || lua_isyieldable(state) == 0)
+        {
+            throw std::invalid_argument(
+                "Error: async bindings can only be called from threads started with spawn"
+            );
+        }
+
+        async.start();
+        if (async.done())
+        {
+            if constexpr (std::is_void_v<R>)
+            {
+                async.result();
+                return 0;
+            }
+            else
+            {
+                TypeDef<R>::push(state, async.result());
+                return 1;
+            }
+        }
+
+        // the coroutine frame now belongs to the thread, see `FinalAwaiter`
+        // (and `ThreadRegistry::close` if the state is closed first)
+        auto handle = std::exchange(async.handle, nullptr);
+        handle.promise().thread = state;
+        thread_state->pending = handle;
+        thread_state->status = ThreadStatus::waiting;
+        return yield_request;
+    }
+
+    /**
+     * Lua function running in its own lua thread, started with `State::spawn`.
+     *
+     * the thread runs until it finishes or waits on a binding returning an `Async`,
+     * so many of them can be interleaved on one state.
+     * c++ coroutines (`Async`) can `co_await` it to get its result, all of them are resumed
+     * when it finishes.
+     *
+     * when the state is closed, the `Async` frames the threads are waiting on are destroyed.
+     * the operations they wait on must not resume them afterwards.
+     */
+    template <typename R = void>
+    class Coroutine final
+    {
+    public:
+        Coroutine(Ref init_thread, std::shared_ptr<ThreadState> init_thread_state)
+            : thread(std::move(init_thread))
+            , thread_state(std::move(init_thread_state))
+        {
+        }
+
+        ThreadStatus status() const
+        {
+            return thread_state->status;
+        }
+
+        bool done() const
+        {
+            return status() == ThreadStatus::done || status() == ThreadStatus::failed;
+        }
+
+        /**
+         * the first value returned by the lua function.
+         * throws the error of the thread, or when it is not finished.
+         */
+        R result() const
+        {
+            if (status() == ThreadStatus::failed)
+            {
+                throw std::invalid_argument("Error: " + thread_state->error);
+            }
+            if (status() != ThreadStatus::done)
+            {
+                throw std::invalid_argument("Error: the thread is not finished");
+            }
+            if constexpr (!std::is_void_v<R>)
+            {
+                auto* state = thread.push();
+                auto* lua_thread = lua_tothread(state, -1);
+                lua_pop(state, 1);
+                return TypeDef<R>::value(
+                    lua_thread,
+                    lua_gettop(lua_thread) - thread_state->results + 1
+                );
+            }
+        }
+
+        auto operator co_await() const noexcept
+        {
+            struct Awaiter
+            {
+                const Coroutine& self;
+
+                bool await_ready() const noexcept
+                {
+                    return self.done();
+                }
+
+                void await_suspend(std::coroutine_handle<> caller) const
+                {
+                    self.thread_state->waiters.push_back(caller);
+                }
+
+                R await_resume() const
+                {
+                    return self.result();
+                }
+            };
+
+            return Awaiter{*this};
+        }
+
+    private:
+        Ref thread;
+        std::shared_ptr<ThreadState> thread_state;
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+namespace nil::luax
+{
+    /**
+     * Lua module precompiled to bytecode and embedded in the binary.
+     *
+     * generated by `target_embed_lua` (see `cmake/embed.cmake`) and registered to a state with
+     * `State::add_embedded`, after which it is found by `require(name)` without touching the
+     * filesystem.
+     *
+     * the bytecode is produced by the lua library used at build time.
+     * lua rejects it on load if the version or the number formats do not match.
+     */
+    struct EmbeddedModule
+    {
+        std::string_view name;
+        std::span<const unsigned char> bytecode;
+    };
+}
@@ -0,0 +1,373 @@
+#pragma once
+
+#include "Context.hpp"
+#include "Ref.hpp"
+#include "Result.hpp"
+#include "TypeDef.hpp"
+#include "error.hpp"
+
+#include <nil/xalt/checks.hpp>
+#include <nil/xalt/str_name.hpp>
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * failure of one element of a batched call (see `Function::call_each`).
+     */
+    struct CallError
+    {
+        std::size_t index;
+        std::string message;
+    };
+
+    /**
+     * Typed handle to a lua function.
+     *
+     * calls go straight through the lua api:
+     *  - the function is fetched from the registry (validated once when pulled)
+     *  - arguments are pushed and the function is called with `lua_pcall`
+     *
+     * for repeated calls, `pin()` keeps the function on the stack for the lifetime
+     * of the returned object, skipping the registry fetch.
+     */
+    template <typename R, typename... Args>
+    class Function<R(Args...)> final
+    {
+    public:
+        class Pinned final
+        {
+        public:
+            Pinned(Pinned&&) = delete;
+            Pinned(const Pinned&) = delete;
+            Pinned& operator=(Pinned&&) = delete;
+            Pinned& operator=(const Pinned&) = delete;
+
+            ~Pinned() noexcept
+            {
+                lua_remove(state, index);
+            }
+
+            R operator()(Args... args) const
+            {
+                lua_pushvalue(state, index);
+                return Function::invoke(state, static_cast<Args>(args)...);
+            }
+
+        private:
+            explicit Pinned(lua_State* init_state)
+                : state(init_state)
+                , index(lua_gettop(state))
+            {
+            }
+
+            lua_State* state;
+            int index;
+
+            friend Function;
+        };
+
+        explicit Function(Ref init_ref)
+            : ref(std::move(init_ref))
+        {
+        }
+
+        Function(Function&&) = default;
+        Function(const Function&) = default;
+        Function& operator=(Function&&) = default;
+        Function& operator=(const Function&) = default;
+
+        ~Function() noexcept = default;
+
+        R operator()(Args... args) const
+        {
+            return invoke(ref.push(), static_cast<Args>(args)...);
+        }
+
+        /**
+         * same as `operator()` but failures are returned instead of thrown.
+         */
+        Result<R> try_call(Args... args) const
+        {
+            auto* state = ref.push();
+            (TypeDef<Args>::push(state, static_cast<Args>(args)), ...);
+            if (const auto status = protected_call(state, sizeof...(Args), result_count());
+                status != LUA_OK)
+            {
+                return Error::from_status(state, status);
+            }
+            if constexpr (std::is_same_v<R, void>)
+            {
+                return {};
+            }
+            else
+            {
+                auto out = R();
+                const auto mismatch = read(state, out);
+                if (mismatch.expected != nullptr)
+                {
+                    auto error = Error::from_type(state, mismatch.index, mismatch.expected);
+                    lua_pop(state, result_count());
+                    return error;
+                }
+                lua_pop(state, result_count());
+                return out;
+            }
+        }
+
+        /**
+         * pushes the function to the stack until the returned object is destroyed.
+         * pinned functions are expected to be released in reverse order.
+         */
+        Pinned pin() const
+        {
+            return Pinned(ref.push());
+        }
+
+        /**
+         * calls the function once per element of the argument spans (struct-of-arrays).
+         * the result of the call for element `i` is written to `out[i]`.
+         *
+         * the function is pushed once for the whole batch.
+         * a failing element (lua error or unexpected return type) does not stop the batch.
+         * `out[i]` is left untouched and the failure is reported in the returned list.
+         */
+        template <typename O = R>
+            requires(!std::is_same_v<O, void>)
+        std::vector<CallError> call_each(
+            std::span<std::type_identity_t<O>> out,
+            std::span<const std::remove_cvref_t<Args>>... args
+        ) const
+        {
+            return batch(out.data(), out.size(), args...);
+        }
+
+        template <typename O = R>
+            requires(std::is_same_v<O, void> && sizeof...(Args) > 0)
+        std::vector<CallError> call_each(std::span<const std::remove_cvref_t<Args>>... args) const
+        {
+            const auto count = std::get<0>(std::forward_as_tuple(args...)).size();
+            return batch(static_cast<void*>(nullptr), count, args...);
+        }
+
+    private:
+        Ref ref;
+
+        static constexpr int result_count()
+        {
+            if constexpr (std::is_same_v<R, void>)
+            {
+                return 0;
+            }
+            else if constexpr (nil::xalt::is_of_template_v<R, std::tuple>)
+            {
+                return int(std::tuple_size_v<R>);
+            }
+            else
+            {
+                return 1;
+            }
+        }
+
+        template <typename O>
+        std::vector<CallError> batch(
+            O* out,
+            std::size_t count,
+            std::span<const std::remove_cvref_t<Args>>... args
+        ) const
+        {
+            if (((args.size() != count) || ...))
+            {
+                throw std::invalid_argument("Error: batch spans have different sizes");
+            }
+
+            auto errors = std::vector<CallError>();
+            const auto pinned = pin();
+            auto* state = pinned.state;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                lua_pushvalue(state, pinned.index);
+                (TypeDef<Args>::push(state, args[i]), ...);
+                if (protected_call(state, sizeof...(Args), result_count()) != LUA_OK)
+                {
+                    errors.push_back({i, pop_error_message(state)});
+                    continue;
+                }
+                if constexpr (!std::is_same_v<O, void>)
+                {
+                    const auto mismatch = read(state, out[i]);
+                    if (mismatch.expected != nullptr)
+                    {
+                        errors.push_back(
+                            {i,
+                             type_error_message(
+                                 state,
+                                 mismatch.expected,
+                                 lua_type(state, mismatch.index)
+                             )}
+                        );
+                    }
+                    lua_pop(state, result_count());
+                }
+            }
+            return errors;
+        }
+
+        struct Mismatch
+        {
+            const char* expected = nullptr;
+            int index = 0;
+        };
+
+        /**
+         * reads the results at the top of the stack.
+         * every result is checked before `out` is written, so it is left untouched when one
+         * of them has an unexpected type (the first one is reported).
+         */
+        template <typename O>
+        static Mismatch read(lua_State* state, O& out)
+        {
+            auto mismatch = Mismatch();
+            if constexpr (nil::xalt::is_of_template_v<O, std::tuple>)
+            {
+                constexpr std::size_t N = std::tuple_size_v<O>;
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    if ((check_one<std::tuple_element_t<I, O>>(state, -int(N - I), mismatch)
+                         && ...))
+                    {
+                        ((std::get<I>(out) = value_one<std::tuple_element_t<I, O>>(
+                              state,
+                              -int(N - I)
+                          )),
+                         ...);
+                    }
+                }(std::make_index_sequence<N>{});
+            }
+            else if (check_one<O>(state, -1, mismatch))
+            {
+                out = value_one<O>(state, -1);
+            }
+            return mismatch;
+        }
+
+        template <typename T>
+        static bool check_one(lua_State* state, int index, Mismatch& mismatch)
+        {
+            using raw_type = std::remove_cvref_t<T>;
+            if (!TypeDef<raw_type>::check(state, index))
+            {
+                mismatch = {xalt::str_name_v<raw_type>, index};
+                return false;
+            }
+            return true;
+        }
+
+        template <typename T>
+        static decltype(auto) value_one(lua_State* state, int index)
+        {
+            return TypeDef<std::remove_cvref_t<T>>::value(state, index);
+        }
+
+        /**
+         * expects the function at the top of the stack.
+         */
+        static R invoke(lua_State* state, Args... args)
+        {
+            (TypeDef<Args>::push(state, static_cast<Args>(args)), ...);
+
+            if constexpr (std::is_same_v<R, void>)
+            {
+                if (protected_call(state, sizeof...(Args), 0) != LUA_OK)
+                {
+                    throw_call_error(state);
+                }
+            }
+            else if constexpr (nil::xalt::is_of_template_v<R, std::tuple>)
+            {
+                constexpr std::size_t N = std::tuple_size_v<R>;
+                if (protected_call(state, sizeof...(Args), int(N)) != LUA_OK)
+                {
+                    throw_call_error(state);
+                }
+                R return_value;
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    ((std::get<I>(return_value)
+                      = TypeDef<std::remove_cvref_t<std::tuple_element_t<I, R>>>::value(
+                          state,
+                          -int(N - I)
+                      )),
+                     ...);
+                }(std::make_index_sequence<N>{});
+                lua_pop(state, int(N));
+                return return_value;
+            }
+            else
+            {
+                if (protected_call(state, sizeof...(Args), 1) != LUA_OK)
+                {
+                    throw_call_error(state);
+                }
+                auto value = TypeDef<R>::value(state, -1);
+                lua_pop(state, 1);
+                return value;
+            }
+        }
+
+        friend TypeDef<Function>;
+    };
+
+    template <typename R, typename... Args>
+    struct TypeDef<Function<R(Args...)>> final
+    {
+        static bool check(lua_State* state, int index)
+        {
+            return lua_isfunction(state, index);
+        }
+
+        static Function<R(Args...)> value(lua_State* state, int index)
+        {
+            if (!check(state, index))
+            {
+                throw_type_error(state, "function", lua_type(state, index));
+            }
+            lua_pushvalue(state, index);
+            return Function<R(Args...)>(Ref(state));
+        }
+
+        static void push(lua_State* state, const Function<R(Args...)>& fn)
+        {
+            auto* from = fn.ref.push();
+            if (from != state)
+            {
+                lua_xmove(from, state, 1);
+            }
+        }
+
+        static Function<R(Args...)> pull(const Ref& ref)
+        {
+            auto* state = ref.push();
+            const auto type = lua_type(state, -1);
+            lua_pop(state, 1);
+            if (type != LUA_TFUNCTION)
+            {
+                throw_type_error(state, "function", type);
+            }
+            return Function<R(Args...)>(ref);
+        }
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace nil::luax
+{
+    /**
+     * incremental collector parameters (see the lua manual, `collectgarbage("incremental")`).
+     * 0 keeps the current value.
+     */
+    struct GcIncremental
+    {
+        /**
+         * how long the collector waits before a new cycle, in percent of the memory in use
+         * after the previous one (lua default: 200).
+         */
+        int pause = 0;
+        /**
+         * speed of the collector relative to allocation, in percent (lua default: 100).
+         */
+        int stepmul = 0;
+        /**
+         * log2 of the size of each step in bytes (lua default: 13, 8KB).
+         */
+        int stepsize = 0;
+    };
+
+    /**
+     * generational collector parameters (see the lua manual, `collectgarbage("generational")`).
+     * 0 keeps the current value.
+     */
+    struct GcGenerational
+    {
+        /**
+         * memory growth that triggers a minor collection, in percent (lua default: 20).
+         */
+        int minormul = 0;
+        /**
+         * memory growth that triggers a major collection, in percent (lua default: 100).
+         */
+        int majormul = 0;
+    };
+
+    struct GcStats
+    {
+        /**
+         * memory in use according to the collector.
+         */
+        std::size_t bytes = 0;
+        bool running = false;
+        bool generational = false;
+        /**
+         * counted by `State::gc_step` only.
+         */
+        std::uint64_t steps = 0;
+        std::uint64_t cycles = 0;
+        std::chrono::nanoseconds time = {};
+    };
+}
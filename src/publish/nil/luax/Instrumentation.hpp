@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * compiled in with `NIL_LUAX_INSTRUMENTATION` (cmake option `ENABLE_INSTRUMENTATION`).
+     * otherwise bindings are not wrapped at all.
+     */
+#ifdef NIL_LUAX_INSTRUMENTATION
+    inline constexpr bool instrumentation_enabled = true;
+#else
+    inline constexpr bool instrumentation_enabled = false;
+#endif
+
+    /**
+     * measurements of one binding, see `State::bindings()`.
+     */
+    struct BindingStats
+    {
+        /**
+         * bucket `i` counts calls that took less than `2^(i + 8)` ns
+         * (and at least half of it), the last bucket counts everything above.
+         */
+        static constexpr std::size_t bucket_count = 16;
+
+        /**
+         * global name for functions set with `State::set`,
+         * `type.member` for methods and `type.member [get]`/`[set]` for properties,
+         * the c++ type name for other closures.
+         */
+        std::string name;
+        std::uint64_t calls = 0;
+        /**
+         * calls that threw.
+         */
+        std::uint64_t errors = 0;
+        std::chrono::nanoseconds total = {};
+        std::array<std::uint64_t, bucket_count> histogram = {};
+
+        static constexpr std::chrono::nanoseconds bucket_limit(std::size_t bucket)
+        {
+            return std::chrono::nanoseconds(std::int64_t(1) << (bucket + 8));
+        }
+    };
+
+    /**
+     * Per binding counters of a state.
+     * slots are created on first use and kept for the lifetime of the state.
+     */
+    class Instrumentation final
+    {
+    public:
+        /**
+         * slot of the binding named `name`, created if needed.
+         */
+        std::size_t slot(std::string_view name)
+        {
+            const auto key = std::string(name);
+            if (const auto it = by_name.find(key); it != by_name.end())
+            {
+                return it->second;
+            }
+            stats.push_back({.name = key});
+            by_name.emplace(key, stats.size() - 1);
+            return stats.size() - 1;
+        }
+
+        /**
+         * same as `slot(name())` for bindings known at compile time (members),
+         * resolved (and named) once per state.
+         */
+        template <typename Key, typename Name>
+        std::size_t slot(const Name& name)
+        {
+            const auto id = id_of<Key>();
+            if (id >= by_id.size())
+            {
+                by_id.resize(id + 1, npos);
+            }
+            if (by_id[id] == npos)
+            {
+                by_id[id] = slot(name());
+            }
+            return by_id[id];
+        }
+
+        template <typename F>
+        decltype(auto) measure(std::size_t index, F&& fn)
+        {
+            const auto start = clock::now();
+            try
+            {
+                if constexpr (std::is_same_v<void, decltype(fn())>)
+                {
+                    fn();
+                    record(index, clock::now() - start, false);
+                }
+                else
+                {
+                    decltype(auto) result = fn();
+                    record(index, clock::now() - start, false);
+                    return result;
+                }
+            }
+            catch (...)
+            {
+                record(index, clock::now() - start, true);
+                throw;
+            }
+        }
+
+        const std::vector<BindingStats>& get() const
+        {
+            return stats;
+        }
+
+        /**
+         * clears the counters, the bindings are kept.
+         */
+        void reset()
+        {
+            for (auto& entry : stats)
+            {
+                entry = {.name = std::move(entry.name)};
+            }
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t npos = ~std::size_t(0);
+
+        std::vector<BindingStats> stats;
+        std::unordered_map<std::string, std::size_t> by_name;
+        std::vector<std::size_t> by_id;
+
+        static std::size_t next_id()
+        {
+            static std::atomic<std::size_t> next = 0;
+            return next++;
+        }
+
+        template <typename Key>
+        static std::size_t id_of()
+        {
+            static const std::size_t id = next_id();
+            return id;
+        }
+
+        void record(std::size_t index, clock::duration elapsed, bool failed)
+        {
+            auto& entry = stats[index];
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+            ++entry.calls;
+            entry.errors += failed ? 1 : 0;
+            entry.total += ns;
+            const auto width = std::size_t(std::bit_width(std::uint64_t(ns.count()) >> 8u));
+            ++entry.histogram[std::min(width, BindingStats::bucket_count - 1)];
+        }
+    };
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "TypeDef.hpp"
+
+#include <nil/xalt/tlist.hpp>
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace nil::luax
+{
+    /**
+     * lua types (as `1 << lua_type`) that `TypeDef<T>::check` may accept.
+     * a cheap necessary condition, the check itself still decides.
+     */
+    template <typename T>
+    constexpr std::uint32_t accepted_types = ~std::uint32_t(0);
+
+    template <typename T>
+        requires(std::is_same_v<bool, T>)
+    constexpr std::uint32_t accepted_types<T> = 1u << LUA_TBOOLEAN;
+
+    template <typename T>
+        requires(std::is_integral_v<T> && !std::is_same_v<bool, T>)
+    constexpr std::uint32_t accepted_types<T> = 1u << LUA_TNUMBER;
+
+    // lua_isnumber and lua_isstring convert between the two
+    template <typename T>
+        requires(std::is_floating_point_v<T>)
+    constexpr std::uint32_t accepted_types<T> = (1u << LUA_TNUMBER) | (1u << LUA_TSTRING);
+
+    template <typename T>
+        requires(std::is_same_v<std::string, T>         //
+                 || std::is_same_v<std::string_view, T> //
+                 || std::is_same_v<const char*, T>)
+    constexpr std::uint32_t accepted_types<T> = (1u << LUA_TNUMBER) | (1u << LUA_TSTRING);
+
+    template <typename T>
+        requires(is_std_fn<T> || is_lua_fn<T>)
+    constexpr std::uint32_t accepted_types<T> = 1u << LUA_TFUNCTION;
+
+    template <typename T>
+        requires(is_user_type<T>)
+    constexpr std::uint32_t accepted_types<T> = 1u << LUA_TUSERDATA;
+
+    /**
+     * Overload resolution for a set of candidates, each providing:
+     *  - `using arg_types = xalt::tlist<...>`
+     *  - `static int call(lua_State*, int first)` reading its arguments from `first`
+     *
+     * candidates are grouped by arity at compile time. a call switches on the number of
+     * arguments, reads the lua type of each argument once and compares it against the
+     * precomputed types of the candidates of that arity. `TypeDef::check` only runs for
+     * the candidates that passed, in declaration order, and the first match is called.
+     */
+    template <typename... C>
+    struct Overloads final
+    {
+        static constexpr std::size_t max_arity = std::max({std::size_t(0), C::arg_types::size...});
+
+        /**
+         * returned when no candidate matches (distinct from `yield_request`).
+         */
+        static constexpr int no_match = -1;
+
+        /**
+         * returns the result of the matching candidate or `no_match` when none matches.
+         * `count` is the number of arguments starting at `first`.
+         */
+        static int call(lua_State* state, int first, int count)
+        {
+            if (count < 0 || std::size_t(count) > max_arity)
+            {
+                return no_match;
+            }
+            return arities[std::size_t(count)](state, first);
+        }
+
+    private:
+        template <typename... Args>
+        static constexpr std::array<std::uint32_t, sizeof...(Args)> accepted(
+            xalt::tlist<Args...> /* arg types */
+        )
+        {
+            return {accepted_types<std::remove_cvref_t<Args>>...};
+        }
+
+        template <typename... Args, std::size_t... I>
+        static bool check(
+            [[maybe_unused]] lua_State* state,
+            [[maybe_unused]] int first,
+            xalt::tlist<Args...> /* arg types */,
+            std::index_sequence<I...> /* arg indices */
+        )
+        {
+            return (true && ... && TypeDef<Args>::check(state, first + int(I)));
+        }
+
+        template <typename Candidate, std::size_t N>
+        static bool try_call(
+            lua_State* state,
+            int first,
+            const std::array<std::uint32_t, N>& types,
+            int& result
+        )
+        {
+            constexpr auto expected = accepted(typename Candidate::arg_types());
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                if ((types[i] & expected[i]) == 0)
+                {
+                    return false;
+                }
+            }
+            using arg_types = typename Candidate::arg_types;
+            if (!check(state, first, arg_types(), std::make_index_sequence<N>()))
+            {
+                return false;
+            }
+            result = Candidate::call(state, first);
+            return true;
+        }
+
+        template <std::size_t N>
+        static int call_arity(lua_State* state, int first)
+        {
+            std::array<std::uint32_t, N> types = {};
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                types[i] = 1u << lua_type(state, first + int(i));
+            }
+
+            int result = no_match;
+            const auto try_next = [&]<typename Candidate>()
+            {
+                if constexpr (Candidate::arg_types::size == N)
+                {
+                    return try_call<Candidate>(state, first, types, result);
+                }
+                else
+                {
+                    return false;
+                }
+            };
+            (void)(false || ... || try_next.template operator()<C>());
+            return result;
+        }
+
+        template <std::size_t... N>
+        static constexpr auto make_arities(std::index_sequence<N...> /* arities */)
+        {
+            return std::array<int (*)(lua_State*, int), sizeof...(N)>{&call_arity<N>...};
+        }
+
+        static constexpr auto arities = make_arities(std::make_index_sequence<max_arity + 1>());
+    };
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+extern "C"
+{
+#include <lua.h>
+}
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * Sampling profiler driven by the count hook of the state (see `State::start_profiler`).
+     *
+     * every `interval` vm instructions, the call stack is recorded, including the frames of
+     * c functions (bindings registered with `State::set`, user type methods...) that called
+     * back into lua. samples are weighted by instructions, not time: time spent inside a
+     * binding is not sampled.
+     *
+     * stacks are aggregated as folded text (`root;...;leaf count`) as expected by
+     * flamegraph tools (`flamegraph.pl`, speedscope, inferno...).
+     * nothing is installed while stopped.
+     */
+    class Profiler final
+    {
+    public:
+        static constexpr std::uint64_t default_interval = 10000;
+
+        void start(std::uint64_t init_interval = default_interval)
+        {
+            interval = init_interval == 0 ? default_interval : init_interval;
+            countdown = interval;
+        }
+
+        void stop()
+        {
+            interval = 0;
+            countdown = 0;
+        }
+
+        bool running() const
+        {
+            return interval != 0;
+        }
+
+        /**
+         * instructions until the next sample, 0 when stopped.
+         */
+        std::uint64_t due() const
+        {
+            return countdown;
+        }
+
+        /**
+         * called by the hook after `count` instructions.
+         */
+        void tick(lua_State* state, std::uint64_t count)
+        {
+            if (countdown == 0)
+            {
+                return;
+            }
+            if (count < countdown)
+            {
+                countdown -= count;
+                return;
+            }
+            countdown = interval;
+            sample(state);
+        }
+
+        std::uint64_t samples() const
+        {
+            return total;
+        }
+
+        /**
+         * one line per distinct stack: `frame;frame;frame count`.
+         */
+        std::string folded() const
+        {
+            auto result = std::string();
+            for (const auto& [stack, count] : stacks)
+            {
+                result += stack;
+                result += ' ';
+                result += std::to_string(count);
+                result += '\n';
+            }
+            return result;
+        }
+
+        void clear()
+        {
+            stacks.clear();
+            total = 0;
+        }
+
+    private:
+        std::uint64_t interval = 0;
+        std::uint64_t countdown = 0;
+        std::uint64_t total = 0;
+        std::unordered_map<std::string, std::uint64_t> stacks;
+
+        // reused between samples
+        std::vector<lua_Debug> frames;
+        std::string key;
+
+        void sample(lua_State* state)
+        {
+            frames.clear();
+            auto ar = lua_Debug();
+            for (int level = 0; lua_getstack(state, level, &ar) != 0; ++level)
+            {
+                lua_getinfo(state, "Sn", &ar);
+                frames.push_back(ar);
+            }
+
+            key.clear();
+            for (auto it = frames.rbegin(); it != frames.rend(); ++it)
+            {
+                if (it != frames.rbegin())
+                {
+                    key += ';';
+                }
+                append_frame(*it);
+            }
+            ++stacks[key];
+            ++total;
+        }
+
+        void append_frame(const lua_Debug& frame)
+        {
+            if (frame.what[0] == 'C')
+            {
+                append(frame.name == nullptr ? "?" : frame.name);
+                key += " [C]";
+                return;
+            }
+            if (frame.what[0] == 'm')
+            {
+                append("main");
+            }
+            else
+            {
+                append(frame.name == nullptr ? "?" : frame.name);
+            }
+            key += " (";
+            append(frame.short_src);
+            if (frame.what[0] != 'm')
+            {
+                key += ':';
+                key += std::to_string(frame.linedefined);
+            }
+            key += ')';
+        }
+
+        /**
+         * `;` separates frames and a line is one stack, both are replaced.
+         */
+        void append(const char* text)
+        {
+            for (; *text != '\0'; ++text)
+            {
+                key += (*text == ';' || *text == '\n') ? '_' : *text;
+            }
+        }
+    };
+}
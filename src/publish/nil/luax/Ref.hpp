@@ -1,32 +1,76 @@
 #pragma once
 
+#include "Context.hpp"
+
 extern "C"
 {
-#include <lauxlib.h>
+#include <lua.h>
 }
 
+#include <utility>
+
 namespace nil::luax
 {
-    class Ref
+    /**
+     * Handle to a lua value stored in the registry.
+     *
+     * copies share the same registry slot (see `RefPool`).
+     * the handle is only valid while its `State` is alive.
+     */
+    class Ref final
     {
     public:
+        /**
+         * pops the value at the top of the stack.
+         */
         explicit Ref(lua_State* init_state)
             : state(init_state)
-            , ref(luaL_ref(state, LUA_REGISTRYINDEX))
+            , ref(Context::from(state).refs.acquire(state))
+        {
+        }
+
+        Ref(Ref&& other) noexcept
+            : state(other.state)
+            , ref(std::exchange(other.ref, LUA_NOREF))
         {
         }
 
-        Ref(Ref&&) = delete;
-        Ref(const Ref&) = delete;
-        Ref& operator=(Ref&&) = delete;
-        Ref& operator=(const Ref&) = delete;
+        Ref(const Ref& other)
+            : state(other.state)
+            , ref(other.ref)
+        {
+            retain();
+        }
+
+        Ref& operator=(Ref&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                state = other.state;
+                ref = std::exchange(other.ref, LUA_NOREF);
+            }
+            return *this;
+        }
 
-        ~Ref()
+        Ref& operator=(const Ref& other)
         {
-            luaL_unref(state, LUA_REGISTRYINDEX, ref);
+            if (this != &other)
+            {
+                release();
+                state = other.state;
+                ref = other.ref;
+                retain();
+            }
+            return *this;
         }
 
-        lua_State* push()
+        ~Ref() noexcept
+        {
+            release();
+        }
+
+        lua_State* push() const
         {
             lua_rawgeti(state, LUA_REGISTRYINDEX, ref);
             return state;
@@ -35,5 +79,21 @@ namespace nil::luax
     private:
         lua_State* state;
         int ref;
+
+        void retain()
+        {
+            if (ref >= 0)
+            {
+                Context::from(state).refs.retain(ref);
+            }
+        }
+
+        void release() noexcept
+        {
+            if (ref >= 0)
+            {
+                Context::from(state).refs.release(state, ref);
+            }
+        }
     };
 }
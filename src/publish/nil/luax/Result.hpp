@@ -0,0 +1,233 @@
+#pragma once
+
+#include "Ref.hpp"
+#include "error.hpp"
+
+extern "C"
+{
+#include <lauxlib.h>
+#include <lua.h>
+}
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace nil::luax
+{
+    /**
+     * Error reported by the non-throwing api (`try_*`).
+     *
+     * nothing is formatted until `message()` is called.
+     * for lua errors, the error object is kept in the registry.
+     */
+    struct Error final
+    {
+        enum class Status
+        {
+            runtime = LUA_ERRRUN,
+            syntax = LUA_ERRSYNTAX,
+            memory = LUA_ERRMEM,
+            handler = LUA_ERRERR,
+            file = LUA_ERRFILE,
+            type = LUA_ERRFILE + 1,
+            /**
+             * aborted by the budget of the state (see `State::set_budget`).
+             */
+            budget = LUA_ERRFILE + 2
+        };
+
+        Status status;
+        /**
+         * for `Status::type`, stack index (relative to the values being read) of the mismatch.
+         */
+        int index = 0;
+        /**
+         * for `Status::type`, expected and actual type names.
+         */
+        const char* expected = nullptr;
+        const char* actual = nullptr;
+        /**
+         * for lua errors, the error object.
+         */
+        std::optional<Ref> object = std::nullopt;
+
+        /**
+         * pops the error object returned by a failed `lua_pcall`/`luaL_load*`.
+         */
+        static Error from_status(lua_State* state, int status)
+        {
+            if (Context::from(state).budget.raised_by_hook(lua_topointer(state, -1)))
+            {
+                return {.status = Status::budget, .object = Ref(state)};
+            }
+            return {.status = Status(status), .object = Ref(state)};
+        }
+
+        static Error from_type(lua_State* state, int index, const char* expected)
+        {
+            return {
+                .status = Status::type,
+                .index = index,
+                .expected = expected,
+                .actual = luaL_typename(state, index)
+            };
+        }
+
+        /**
+         * throws `BudgetError` for `Status::budget`, `std::invalid_argument` otherwise.
+         */
+        [[noreturn]] void raise() const
+        {
+            if (status == Status::budget)
+            {
+                throw BudgetError("Error: " + message());
+            }
+            throw std::invalid_argument("Error: " + message());
+        }
+
+        std::string message() const
+        {
+            if (status == Status::type)
+            {
+                return "expected [" + std::string(expected) + "], got [" + actual + "]";
+            }
+            if (!object.has_value())
+            {
+                return "unknown error";
+            }
+            auto* state = object->push();
+            const auto* text = lua_tostring(state, -1);
+            auto result = std::string(text == nullptr ? "(error object is not a string)" : text);
+            lua_pop(state, 1);
+            return result;
+        }
+    };
+
+    /**
+     * Either a value or an `Error` (`std::expected` is only available from c++23).
+     * references are stored as pointers.
+     */
+    template <typename T>
+    class Result final
+    {
+    private:
+        using stored_type = std::conditional_t<
+            std::is_reference_v<T>,
+            std::add_pointer_t<std::remove_reference_t<T>>,
+            T>;
+
+    public:
+        // NOLINTNEXTLINE
+        Result(T init_value)
+            requires(!std::is_reference_v<T>)
+            : data(std::in_place_index<0>, std::move(init_value))
+        {
+        }
+
+        // NOLINTNEXTLINE
+        Result(T init_value)
+            requires(std::is_reference_v<T>)
+            : data(std::in_place_index<0>, &init_value)
+        {
+        }
+
+        // NOLINTNEXTLINE
+        Result(Error init_error)
+            : data(std::in_place_index<1>, std::move(init_error))
+        {
+        }
+
+        bool has_value() const
+        {
+            return data.index() == 0;
+        }
+
+        explicit operator bool() const
+        {
+            return has_value();
+        }
+
+        /**
+         * throws if the result is an error.
+         */
+        decltype(auto) value() const
+        {
+            if (!has_value())
+            {
+                error().raise();
+            }
+            return **this;
+        }
+
+        decltype(auto) operator*() const
+        {
+            if constexpr (std::is_reference_v<T>)
+            {
+                return static_cast<T>(*std::get<0>(data));
+            }
+            else
+            {
+                return (std::get<0>(data));
+            }
+        }
+
+        const auto* operator->() const
+        {
+            return &**this;
+        }
+
+        const Error& error() const
+        {
+            return std::get<1>(data);
+        }
+
+    private:
+        std::variant<stored_type, Error> data;
+    };
+
+    template <>
+    class Result<void> final
+    {
+    public:
+        Result() = default;
+
+        // NOLINTNEXTLINE
+        Result(Error init_error)
+            : data(std::move(init_error))
+        {
+        }
+
+        bool has_value() const
+        {
+            return !data.has_value();
+        }
+
+        explicit operator bool() const
+        {
+            return has_value();
+        }
+
+        /**
+         * throws if the result is an error.
+         */
+        void value() const
+        {
+            if (!has_value())
+            {
+                error().raise();
+            }
+        }
+
+        const Error& error() const
+        {
+            return *data;
+        }
+
+    private:
+        std::optional<Error> data;
+    };
+}
@@ -1,5 +1,17 @@
 #pragma once
 
+#include "Allocator.hpp"
+#include "ArrayView.hpp"
+#include "Bytes.hpp"
+#include "ChunkCache.hpp"
+#include "Container.hpp"
+#include "Context.hpp"
+#include "Coroutine.hpp"
+#include "Embedded.hpp"
+#include "Function.hpp"
+#include "Gc.hpp"
+#include "Overload.hpp"
+#include "Result.hpp"
 #include "Ref.hpp"
 #include "TypeDef.hpp"
 #include "UserType.hpp"
@@ -16,8 +28,23 @@ extern "C"
 #include <lualib.h>
 }
 
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace nil::luax
 {
@@ -39,20 +66,59 @@ namespace nil::luax
         }
 
     public:
-        State() = default;
+        State()
+            : state(luaL_newstate())
+            , ctx(std::make_unique<Context>())
+        {
+            ctx->attach(state);
+            ctx->memory.install(state);
+        }
 
-        State(State&&) = default;
-        State& operator=(State&&) = default;
+        /**
+         * every allocation of the state goes through `allocator` (see `is_allocator`).
+         * the allocator is expected to outlive the state.
+         * panics and warnings (`warn`) are handled as with the default constructor.
+         */
+        template <is_allocator Allocator>
+        explicit State(Allocator& allocator)
+            : state(lua_newstate(&State::reallocate<Allocator>, &allocator))
+            , ctx(std::make_unique<Context>())
+        {
+            if (state == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            lua_atpanic(state, &State::panic);
+            lua_setwarnf(state, &State::warn_off, state);
+            ctx->attach(state);
+            ctx->memory.install(state);
+        }
+
+        State(State&& other) noexcept
+            : state(std::exchange(other.state, nullptr))
+            , chunk_cache(std::exchange(other.chunk_cache, nullptr))
+            , ctx(std::move(other.ctx))
+        {
+        }
+
+        State& operator=(State&& other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                state = std::exchange(other.state, nullptr);
+                chunk_cache = std::exchange(other.chunk_cache, nullptr);
+                ctx = std::move(other.ctx);
+            }
+            return *this;
+        }
 
         State(const State&) = delete;
         State& operator=(const State&) = delete;
 
         ~State() noexcept
         {
-            if (state != nullptr)
-            {
-                lua_close(state);
-            }
+            close();
         }
 
         void open_libs()
@@ -62,24 +128,204 @@ namespace nil::luax
 
         void load(std::string_view path)
         {
-            if (luaL_dofile(state, path.data()) != LUA_OK)
+            try_load(path).value();
+        }
+
+        void run(std::string_view script)
+        {
+            try_run(script).value();
+        }
+
+        /**
+         * same as `load` but failures are returned instead of thrown.
+         */
+        Result<void> try_load(std::string_view path)
+        {
+            if (chunk_cache != nullptr)
             {
-                throw_error(state);
+                if (auto source = read_source(path); source.has_value())
+                {
+                    const auto chunkname = "@" + std::string(path);
+                    return call_chunk(protected_load(
+                        [&](lua_State* /* state */)
+                        { return load_cached(chunkname.c_str(), *source); }
+                    ));
+                }
             }
+            return call_chunk(protected_load(
+                [path](lua_State* s) { return luaL_loadfile(s, path.data()); }
+            ));
         }
 
-        void run(std::string_view script)
+        /**
+         * same as `run` but failures are returned instead of thrown.
+         */
+        Result<void> try_run(std::string_view script)
+        {
+            if (chunk_cache != nullptr)
+            {
+                return call_chunk(protected_load(
+                    [&](lua_State* /* state */) { return load_cached(script.data(), script); }
+                ));
+            }
+            return call_chunk(protected_load(
+                [script](lua_State* s) { return luaL_loadstring(s, script.data()); }
+            ));
+        }
+
+        /**
+         * makes the modules loadable with `require` from memory.
+         * the searcher is inserted right after `package.preload`, before the filesystem.
+         * `package` is expected to be loaded (see `open_libs`).
+         */
+        void add_embedded(std::span<const EmbeddedModule> modules)
         {
-            if (luaL_dostring(state, script.data()) != LUA_OK)
+            auto& embedded = ctx->embedded;
+            const auto install = embedded.empty();
+            embedded.insert(embedded.end(), modules.begin(), modules.end());
+            if (!install)
             {
-                throw_error(state);
+                return;
             }
+
+            const auto top = lua_gettop(state);
+            if (lua_getglobal(state, "package") != LUA_TTABLE
+                || lua_getfield(state, -1, "searchers") != LUA_TTABLE)
+            {
+                lua_settop(state, top);
+                embedded.clear();
+                throw std::invalid_argument("Error: package library is not loaded");
+            }
+            for (auto i = lua_Integer(luaL_len(state, -1)); i >= 2; --i)
+            {
+                lua_rawgeti(state, -1, i);
+                lua_rawseti(state, -2, i + 1);
+            }
+            lua_pushcfunction(state, &protect<&State::search_embedded>);
+            lua_rawseti(state, -2, 2);
+            lua_pop(state, 2);
+        }
+
+        /**
+         * bounds the execution from now on, until the budget is set again or cleared.
+         * set it before each call to bound calls individually.
+         *
+         * when exceeded, the running call fails with `BudgetError`
+         * (`Error::Status::budget` with the `try_*` api) and so does every following call
+         * running lua code.
+         * the main thread is hooked, and so are the threads started with `spawn` each time
+         * they are resumed. lua coroutines get the hook of the thread creating them, those
+         * created (by lua) before this call are not bounded.
+         *
+         * without a budget, no hook is installed and nothing is paid.
+         * with one, lua goes through its hook dispatch on every instruction,
+         * which roughly doubles the time of tight loops (see the `budget_*` benchmarks).
+         */
+        void set_budget(const Budget& budget)
+        {
+            ctx->budget.arm(budget);
+            ctx->update_hook(state);
+        }
+
+        void clear_budget()
+        {
+            ctx->budget.disarm();
+            ctx->update_hook(state);
+        }
+
+        /**
+         * samples the lua call stack every `interval` instructions until stopped.
+         * samples accumulate across start/stop, see `profiler().folded()` and `clear()`.
+         *
+         * while running, it has the cost of a budget (lua hook dispatch on every instruction)
+         * plus one stack walk per sample. stopped, it costs nothing.
+         */
+        void start_profiler(std::uint64_t interval = Profiler::default_interval)
+        {
+            ctx->profiler.start(interval);
+            ctx->update_hook(state);
+        }
+
+        void stop_profiler()
+        {
+            ctx->profiler.stop();
+            ctx->update_hook(state);
+        }
+
+        Profiler& profiler()
+        {
+            return ctx->profiler;
+        }
+
+        /**
+         * per binding call counts, latencies and errors (see `BindingStats`).
+         * always empty unless built with `NIL_LUAX_INSTRUMENTATION`.
+         */
+        std::vector<BindingStats> bindings() const
+        {
+            return ctx->instrumentation.get();
+        }
+
+        void reset_bindings()
+        {
+            ctx->instrumentation.reset();
+        }
+
+        /**
+         * caps the memory used by the state (0 removes the limit).
+         * an allocation that would exceed it fails with a lua memory error
+         * (`Error::Status::memory` with the `try_*` api).
+         *
+         * the limit applies while lua code runs or is loaded (`run`, `load`, calls to lua
+         * functions). the host can still push values, create references and register
+         * bindings above it, these allocations are only accounted for.
+         */
+        void set_memory_limit(std::size_t bytes)
+        {
+            ctx->memory.set_limit(bytes);
+        }
+
+        MemoryStats memory() const
+        {
+            return ctx->memory.get();
+        }
+
+        /**
+         * enables the bytecode cache for `load` and `run` (`nullptr` disables it).
+         * the cache can be shared by multiple states and is expected to outlive them.
+         */
+        void set_chunk_cache(ChunkCache* cache)
+        {
+            chunk_cache = cache;
         }
 
         Var get(std::string_view name)
         {
             lua_getglobal(state, name.data());
-            return Var(std::make_shared<Ref>(state));
+            return Var(Ref(state));
+        }
+
+        /**
+         * calls `fn(args...)` in a new lua thread, which runs until it finishes or waits on a
+         * binding returning an `Async` (it is then resumed when the `Async` completes).
+         * many threads can wait at the same time, each with its own stack.
+         *
+         * the returned `Coroutine` gives the first result of `fn` once it is done,
+         * and can be awaited by a c++ coroutine.
+         */
+        template <typename R = void, typename... Args>
+        Coroutine<R> spawn(const Var& fn, Args&&... args)
+        {
+            auto* thread = lua_newthread(state);
+            lua_pushvalue(state, -1);
+            auto thread_state = ctx->threads.add(state, thread);
+            auto ref = Ref(state);
+
+            TypeDef<Var>::push(state, fn);
+            lua_xmove(state, thread, 1);
+            (TypeDef<std::decay_t<Args>>::push(thread, std::forward<Args>(args)), ...);
+            resume_thread(thread, int(sizeof...(Args)));
+            return Coroutine<R>(std::move(ref), std::move(thread_state));
         }
 
         template <typename T>
@@ -90,7 +336,20 @@ namespace nil::luax
             requires(is_valid_set<T>())
         void set(std::string_view name, T&& fn)
         {
-            TypeDef<T>::push(state, std::forward<T>(fn));
+            using raw_type = std::remove_cvref_t<T>;
+            if constexpr (instrumentation_enabled          //
+                          && !is_value_type<raw_type>      //
+                          && !is_user_type<raw_type>       //
+                          && !is_container_type<raw_type>  //
+                          && !is_lua_fn<raw_type>)
+            {
+                // measured under the global name
+                TypeDefCommon<raw_type>::push_closure(state, std::forward<T>(fn), name);
+            }
+            else
+            {
+                TypeDef<T>::push(state, std::forward<T>(fn));
+            }
             lua_setglobal(state, name.data());
         }
 
@@ -108,51 +367,487 @@ namespace nil::luax
             set(name, [fn](Args... args) { return fn(std::forward<Args>(args)...); });
         }
 
+        /**
+         * binds `fn` as a plain `lua_CFunction` generated at compile time:
+         * no userdata, no upvalue and a direct (inlinable) call.
+         */
+        template <auto fn>
+            requires(std::is_function_v<std::remove_pointer_t<decltype(fn)>>)
+        void set(std::string_view name)
+        {
+            name_binding<&State::bound<fn>>(name);
+            lua_pushcfunction(state, &protect<&State::measured<&State::bound<fn>>>);
+            lua_setglobal(state, name.data());
+        }
+
+        /**
+         * binds the free functions `fns` as one overload set.
+         * a call is dispatched on the number of arguments first, then on their types,
+         * the first function (in the given order) that accepts them is called.
+         */
+        template <auto... fns>
+            requires(sizeof...(fns) > 1)
+                 && (std::is_function_v<std::remove_pointer_t<decltype(fns)>> && ...)
+        void set(std::string_view name)
+        {
+            name_binding<&State::overloaded<fns...>>(name);
+            lua_pushcfunction(state, (&protect<&State::measured<&State::overloaded<fns...>>>));
+            lua_setglobal(state, name.data());
+        }
+
+        /**
+         * same as `set<fn>(name)` for a member function of `object`,
+         * kept as a light userdata upvalue (`object` is expected to outlive the state).
+         */
+        template <auto fn>
+            requires(std::is_member_function_pointer_v<decltype(fn)>)
+        void set(std::string_view name, typename xalt::fn_sign<decltype(fn)>::class_type* object)
+        {
+            name_binding<&State::bound_member<fn>>(name);
+            lua_pushlightuserdata(state, object);
+            lua_pushcclosure(state, &protect<&State::measured<&State::bound_member<fn>>>, 1);
+            lua_setglobal(state, name.data());
+        }
+
+        /**
+         * full collection.
+         */
         void gc()
         {
             lua_gc(state, LUA_GCCOLLECT, 0);
         }
 
-        int stack_depth()
+        /**
+         * switches to the incremental collector (lua default).
+         */
+        void set_gc(const GcIncremental& mode)
         {
-            return lua_gettop(state);
+            lua_gc(state, LUA_GCINC, mode.pause, mode.stepmul, mode.stepsize);
+            ctx->gc.generational = false;
         }
 
-        template <is_user_type T>
-        void add_type()
+        void set_gc(const GcGenerational& mode)
+        {
+            lua_gc(state, LUA_GCGEN, mode.minormul, mode.majormul);
+            ctx->gc.generational = true;
+        }
+
+        /**
+         * stops (or restarts) the automatic collection, leaving `gc_step` in control.
+         */
+        void set_gc_running(bool running)
         {
-            luaL_newmetatable(state, xalt::str_name_v<T>);
-            lua_pushcfunction(state, &UserType<T>::type_close);
-            lua_setfield(state, -2, "__close");
-            if constexpr (requires() { &T::operator(); })
+            lua_gc(state, running ? LUA_GCRESTART : LUA_GCSTOP);
+        }
+
+        /**
+         * runs basic collector steps until `budget` is spent or a cycle completes.
+         * at least one step is run, so the budget can be exceeded by one step
+         * (see `GcIncremental::stepsize`).
+         * returns true if a cycle completed.
+         *
+         * in generational mode, a step is a whole minor (or major) collection which lua never
+         * reports as a completed cycle. exactly one is run, whatever the budget, and it counts
+         * as a completed cycle.
+         */
+        bool gc_step(std::chrono::microseconds budget)
+        {
+            using clock = std::chrono::steady_clock;
+            const auto start = clock::now();
+            const auto deadline = start + budget;
+            auto completed = false;
+            if (ctx->gc.generational)
             {
-                lua_pushcfunction(state, &UserType<T>::type_call);
-                lua_setfield(state, -2, "__call");
+                lua_gc(state, LUA_GCSTEP, 0);
+                ++ctx->gc.steps;
+                completed = true;
             }
-            if constexpr (requires() { typename Meta<T>::Members; })
+            else
             {
-                lua_pushcfunction(state, &UserType<T>::type_index);
-                lua_setfield(state, -2, "__index");
-                lua_pushcfunction(state, &UserType<T>::type_newindex);
-                lua_setfield(state, -2, "__newindex");
-                lua_pushcfunction(state, &UserType<T>::type_pairs);
-                lua_setfield(state, -2, "__pairs");
+                do
+                {
+                    completed = lua_gc(state, LUA_GCSTEP, 0) != 0;
+                    ++ctx->gc.steps;
+                } while (!completed && clock::now() < deadline);
             }
-            // TODO:
-            //  -  __tostring
-            //  -  __concat
-            //  -  __gc (?)
+
+            ctx->gc.cycles += completed ? 1 : 0;
+            ctx->gc.time += clock::now() - start;
+            return completed;
+        }
+
+        GcStats gc_stats() const
+        {
+            auto stats = ctx->gc;
+            stats.bytes = std::size_t(lua_gc(state, LUA_GCCOUNT)) * 1024u
+                + std::size_t(lua_gc(state, LUA_GCCOUNTB));
+            stats.running = lua_gc(state, LUA_GCISRUNNING) != 0;
+            return stats;
+        }
+
+        int stack_depth()
+        {
+            return lua_gettop(state);
+        }
+
+        template <is_user_type T>
+        void add_type()
+        {
+            UserType<T>::push_metatable(state);
+            lua_pop(state, 1);
         }
 
         template <is_user_type T>
             requires requires() { typename Meta<T>::Constructors; }
         void add_type(std::string_view name)
         {
-            lua_register(state, name.data(), &UserType<T>::type_constructors);
+            ctx->types.set_name<T>(name);
+            lua_register(state, name.data(), &protect<&UserType<T>::type_constructors>);
             add_type<T>();
         }
 
     private:
-        lua_State* state = luaL_newstate();
+        lua_State* state;
+        ChunkCache* chunk_cache = nullptr;
+        // destroyed after `state` is closed since finalizers may still need it
+        std::unique_ptr<Context> ctx;
+
+        template <typename Allocator>
+        static void* reallocate(void* ud, void* ptr, std::size_t old_size, std::size_t new_size)
+        {
+            return static_cast<Allocator*>(ud)->reallocate(ptr, old_size, new_size);
+        }
+
+        /**
+         * same as the panic function installed by `luaL_newstate`.
+         */
+        static int panic(lua_State* state)
+        {
+            const char* message = lua_tostring(state, -1);
+            std::fprintf(
+                stderr,
+                "PANIC: unprotected error in call to Lua API (%s)\n",
+                message == nullptr ? "error object is not a string" : message
+            );
+            std::fflush(stderr);
+            return 0;
+        }
+
+        /**
+         * same warning functions as the ones installed by `luaL_newstate`:
+         * warnings start off, are switched with `@on` / `@off` and written to stderr.
+         * [ud] - the main thread
+         */
+        static bool warn_control(lua_State* state, const char* message, int to_continue)
+        {
+            if (to_continue != 0 || *message != '@')
+            {
+                return false;
+            }
+            const auto control = std::string_view(message + 1);
+            if (control == "off")
+            {
+                lua_setwarnf(state, &State::warn_off, state);
+            }
+            else if (control == "on")
+            {
+                lua_setwarnf(state, &State::warn_on, state);
+            }
+            return true;
+        }
+
+        static void warn_off(void* ud, const char* message, int to_continue)
+        {
+            warn_control(static_cast<lua_State*>(ud), message, to_continue);
+        }
+
+        static void warn_on(void* ud, const char* message, int to_continue)
+        {
+            if (!warn_control(static_cast<lua_State*>(ud), message, to_continue))
+            {
+                std::fputs("Lua warning: ", stderr);
+                warn_continue(ud, message, to_continue);
+            }
+        }
+
+        static void warn_continue(void* ud, const char* message, int to_continue)
+        {
+            auto* state = static_cast<lua_State*>(ud);
+            std::fputs(message, stderr);
+            if (to_continue != 0)
+            {
+                lua_setwarnf(state, &State::warn_continue, state);
+            }
+            else
+            {
+                std::fputs("\n", stderr);
+                lua_setwarnf(state, &State::warn_on, state);
+            }
+            std::fflush(stderr);
+        }
+
+        template <lua_CFunction fn>
+        struct Bound
+        {
+        };
+
+        /**
+         * a function bound with `set<fn>` is measured under the first name it is set with.
+         */
+        template <lua_CFunction fn>
+        void name_binding(std::string_view name)
+        {
+            if constexpr (instrumentation_enabled)
+            {
+                const auto make_name = [name]() { return std::string(name); };
+                ctx->instrumentation.template slot<Bound<fn>>(make_name);
+            }
+        }
+
+        template <lua_CFunction fn>
+        static int measured(lua_State* state)
+        {
+            if constexpr (instrumentation_enabled)
+            {
+                auto& instrumentation = Context::from(state).instrumentation;
+                const auto slot = instrumentation.template slot<Bound<fn>>(
+                    []() { return std::string("?"); }
+                );
+                return instrumentation.measure(slot, [state]() { return fn(state); });
+            }
+            else
+            {
+                return fn(state);
+            }
+        }
+
+        template <auto fn>
+        static int bound(lua_State* state)
+        {
+            return BoundCall<fn>::call(state, 1);
+        }
+
+        template <auto fn>
+        struct BoundCall
+        {
+            using sign = xalt::fn_sign<decltype(fn)>;
+            using arg_types = typename sign::arg_types;
+
+            static int call(lua_State* state, int first)
+            {
+                return call_and_push<typename sign::return_type>(
+                    state,
+                    first,
+                    arg_types(),
+                    std::make_index_sequence<arg_types::size>(),
+                    fn
+                );
+            }
+        };
+
+        template <auto... fns>
+        static int overloaded(lua_State* state)
+        {
+            using overloads = Overloads<BoundCall<fns>...>;
+            const auto count = overloads::call(state, 1, lua_gettop(state));
+            if (count == overloads::no_match)
+            {
+                throw std::invalid_argument("Error: no overload matches the provided arguments");
+            }
+            return count;
+        }
+
+        /**
+         * [upvalue 1] - light userdata of the object
+         */
+        template <auto fn>
+        static int bound_member(lua_State* state)
+        {
+            using sign = xalt::fn_sign<decltype(fn)>;
+            auto* object = static_cast<typename sign::class_type*>(
+                lua_touserdata(state, lua_upvalueindex(1))
+            );
+            return call_and_push<typename sign::return_type>(
+                state,
+                1,
+                typename sign::arg_types(),
+                std::make_index_sequence<sign::arg_types::size>(),
+                [object]<typename... A>(A&&... args) -> decltype(auto)
+                { return (object->*fn)(std::forward<A>(args)...); }
+            );
+        }
+
+        /**
+         * `package.searchers` entry for the modules registered with `add_embedded`.
+         */
+        static int search_embedded(lua_State* state)
+        {
+            std::size_t size = 0;
+            const char* name = lua_tolstring(state, 1, &size);
+            if (name == nullptr)
+            {
+                throw_type_error(state, "string", lua_type(state, 1));
+            }
+            const auto& embedded = Context::from(state).embedded;
+            const auto it = std::find_if(
+                embedded.begin(),
+                embedded.end(),
+                [key = std::string_view(name, size)](const EmbeddedModule& module)
+                { return module.name == key; }
+            );
+            if (it == embedded.end())
+            {
+                lua_pushfstring(state, "no embedded module '%s'", name);
+                return 1;
+            }
+
+            // the chunk name stored in the bytecode is used
+            const auto* bytecode = reinterpret_cast<const char*>(it->bytecode.data()); // NOLINT
+            if (luaL_loadbufferx(state, bytecode, it->bytecode.size(), name, "b") != LUA_OK)
+            {
+                throw std::invalid_argument(
+                    "Error: embedded module [" + std::string(it->name)
+                    + "] can't be loaded: " + pop_error_message(state)
+                );
+            }
+            lua_pushvalue(state, 1);
+            return 2;
+        }
+
+        /**
+         * loads the bytecode stored in the cache if present, otherwise compiles `source`
+         * and stores its bytecode. same return and stack effect as `luaL_loadbuffer`.
+         */
+        int load_cached(const char* chunkname, std::string_view source)
+        {
+            const auto key = ChunkCache::key(chunkname, source);
+            if (const auto bytecode = chunk_cache->read(key); bytecode.has_value())
+            {
+                const auto status
+                    = luaL_loadbufferx(state, bytecode->data(), bytecode->size(), chunkname, "b");
+                if (status == LUA_OK)
+                {
+                    return status;
+                }
+                // incompatible bytecode, recompiled below
+                lua_pop(state, 1);
+            }
+            const auto status
+                = luaL_loadbufferx(state, source.data(), source.size(), chunkname, "t");
+            if (status == LUA_OK)
+            {
+                auto bytecode = std::string();
+                if (lua_dump(state, &State::dump_writer, &bytecode, 0) == 0)
+                {
+                    chunk_cache->write(key, bytecode);
+                }
+            }
+            return status;
+        }
+
+        static int dump_writer(lua_State* /* state */, const void* p, std::size_t size, void* ud)
+        {
+            try
+            {
+                static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+                return 0;
+            }
+            catch (...)
+            {
+                return 1;
+            }
+        }
+
+        /**
+         * same handling of the first line as `luaL_loadfile` (utf-8 BOM and `#` comment).
+         * nothing is returned for precompiled chunks, they are loaded without the cache.
+         */
+        static std::optional<std::string> read_source(std::string_view path)
+        {
+            auto file = std::ifstream(std::string(path), std::ios::binary);
+            if (!file)
+            {
+                return std::nullopt;
+            }
+            auto source = std::string(std::istreambuf_iterator<char>(file), {});
+            if (file.bad())
+            {
+                return std::nullopt;
+            }
+            if (source.starts_with("\xEF\xBB\xBF"))
+            {
+                source.erase(0, 3);
+            }
+            auto text = std::string_view(source);
+            if (text.starts_with('#'))
+            {
+                const auto end = text.find('\n');
+                text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+            }
+            if (text.starts_with(LUA_SIGNATURE))
+            {
+                return std::nullopt;
+            }
+            if (source.starts_with('#'))
+            {
+                // the newline is kept so that line numbers are preserved
+                source.erase(0, source.find('\n'));
+            }
+            return source;
+        }
+
+        /**
+         * runs `load` (same return and stack effect as `luaL_loadbuffer`) in a protected call,
+         * so that the memory limit is enforced and its errors are reported instead of panicking.
+         */
+        template <typename Load>
+        int protected_load(const Load& load)
+        {
+            lua_pushcfunction(state, &protect<&State::run_load<Load>>);
+            lua_pushlightuserdata(state, const_cast<Load*>(&load)); // NOLINT
+            if (const auto status = protected_call(state, 1, 2); status != LUA_OK)
+            {
+                return status;
+            }
+            const auto status = int(lua_tointeger(state, -2));
+            lua_remove(state, -2);
+            return status;
+        }
+
+        /**
+         * [1] - light userdata of the load function
+         * returns the load status and the chunk (or the error).
+         */
+        template <typename Load>
+        static int run_load(lua_State* state)
+        {
+            const auto& load = *static_cast<const Load*>(lua_touserdata(state, 1));
+            const auto status = load(state);
+            lua_pushinteger(state, status);
+            lua_insert(state, -2);
+            return 2;
+        }
+
+        Result<void> call_chunk(int status)
+        {
+            if (status == LUA_OK)
+            {
+                status = protected_call(state, 0, 0);
+            }
+            if (status != LUA_OK)
+            {
+                return Error::from_status(state, status);
+            }
+            return {};
+        }
+
+        void close() noexcept
+        {
+            if (state != nullptr)
+            {
+                ctx->threads.close();
+                lua_close(std::exchange(state, nullptr));
+            }
+        }
     };
 }
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "State.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nil::luax
+{
+    /**
+     * activity of one worker of a `StatePool` since the pool was created.
+     */
+    struct WorkerStats
+    {
+        /**
+         * jobs started (including the one running).
+         */
+        std::uint64_t jobs = 0;
+        /**
+         * jobs taken from the queue of another worker.
+         */
+        std::uint64_t steals = 0;
+        std::chrono::nanoseconds busy = {};
+        std::chrono::nanoseconds uptime = {};
+
+        double utilization() const
+        {
+            return uptime.count() == 0 ? 0.0 : double(busy.count()) / double(uptime.count());
+        }
+    };
+
+    /**
+     * Fixed set of identical `State`s, one per worker thread.
+     *
+     * every state is built upfront by calling `setup` (registrations, script loading...),
+     * so jobs only pay for the execution.
+     *
+     * each worker has its own queue:
+     *  - jobs submitted from outside the pool are distributed round robin
+     *  - jobs submitted from a job go to the queue of the current worker
+     *  - an idle worker steals from the other queues, so a slow job only delays its own worker
+     *
+     * a job always runs on the state of the worker executing it.
+     * the destructor waits for every submitted job.
+     */
+    class StatePool final
+    {
+    public:
+        using Job = std::function<void(State&)>;
+
+        StatePool(std::size_t count, const std::function<void(State&)>& setup)
+            : start(clock::now())
+        {
+            if (count == 0)
+            {
+                throw std::invalid_argument("Error: a pool needs at least one worker");
+            }
+            workers.reserve(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto& worker = workers.emplace_back(std::make_unique<Worker>());
+                setup(worker->state);
+            }
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                workers[i]->thread = std::thread([this, i]() { work(i); });
+            }
+        }
+
+        StatePool(StatePool&&) = delete;
+        StatePool(const StatePool&) = delete;
+        StatePool& operator=(StatePool&&) = delete;
+        StatePool& operator=(const StatePool&) = delete;
+
+        ~StatePool() noexcept
+        {
+            {
+                const auto lock = std::lock_guard(mutex);
+                stopping = true;
+            }
+            wakeup.notify_all();
+            for (auto& worker : workers)
+            {
+                worker->thread.join();
+            }
+        }
+
+        /**
+         * queues `fn(State&)`.
+         * the returned future holds the result or the exception thrown by the job.
+         */
+        template <typename F>
+        auto submit(F&& fn) -> std::future<std::invoke_result_t<std::decay_t<F>&, State&>>
+        {
+            using R = std::invoke_result_t<std::decay_t<F>&, State&>;
+            // std::function needs a copyable callable (no move_only_function before c++23)
+            auto task = std::make_shared<std::packaged_task<R(State&)>>(std::forward<F>(fn));
+            auto future = task->get_future();
+            push([task = std::move(task)](State& state) { (*task)(state); });
+            return future;
+        }
+
+        std::size_t size() const
+        {
+            return workers.size();
+        }
+
+        std::vector<WorkerStats> stats() const
+        {
+            const auto uptime = clock::now() - start;
+            auto result = std::vector<WorkerStats>();
+            result.reserve(workers.size());
+            for (const auto& worker : workers)
+            {
+                result.push_back({
+                    .jobs = worker->jobs.load(std::memory_order_relaxed),
+                    .steals = worker->steals.load(std::memory_order_relaxed),
+                    .busy = std::chrono::nanoseconds(worker->busy.load(std::memory_order_relaxed)),
+                    .uptime = std::chrono::duration_cast<std::chrono::nanoseconds>(uptime),
+                });
+            }
+            return result;
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        struct Worker
+        {
+            State state;
+            std::mutex mutex;
+            std::deque<Job> queue;
+            std::thread thread;
+            std::atomic<std::uint64_t> jobs = 0;
+            std::atomic<std::uint64_t> steals = 0;
+            std::atomic<std::int64_t> busy = 0;
+        };
+
+        struct Current
+        {
+            const StatePool* pool = nullptr;
+            std::size_t index = 0;
+        };
+
+        std::vector<std::unique_ptr<Worker>> workers;
+        clock::time_point start;
+        std::atomic<std::size_t> next = 0;
+
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        // incremented under `mutex` so that a sleeping worker can not miss a job
+        std::atomic<std::size_t> pending = 0;
+        bool stopping = false;
+
+        static Current& current()
+        {
+            thread_local auto value = Current();
+            return value;
+        }
+
+        void push(Job job)
+        {
+            const auto& self = current();
+            const auto index = self.pool == this
+                ? self.index
+                : next.fetch_add(1, std::memory_order_relaxed) % workers.size();
+            {
+                auto& worker = *workers[index];
+                const auto lock = std::lock_guard(worker.mutex);
+                worker.queue.push_back(std::move(job));
+            }
+            {
+                const auto lock = std::lock_guard(mutex);
+                pending.fetch_add(1, std::memory_order_relaxed);
+            }
+            wakeup.notify_one();
+        }
+
+        static bool pop(Worker& worker, Job& job)
+        {
+            const auto lock = std::lock_guard(worker.mutex);
+            if (worker.queue.empty())
+            {
+                return false;
+            }
+            job = std::move(worker.queue.front());
+            worker.queue.pop_front();
+            return true;
+        }
+
+        /**
+         * own queue first, then the other queues starting from the next worker.
+         */
+        bool take(std::size_t index, Job& job)
+        {
+            if (pop(*workers[index], job))
+            {
+                return true;
+            }
+            for (std::size_t i = 1; i < workers.size(); ++i)
+            {
+                if (pop(*workers[(index + i) % workers.size()], job))
+                {
+                    workers[index]->steals.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work(std::size_t index)
+        {
+            current() = {this, index};
+            auto& worker = *workers[index];
+            auto job = Job();
+            while (true)
+            {
+                if (!take(index, job))
+                {
+                    auto lock = std::unique_lock(mutex);
+                    wakeup.wait(lock, [this]() { return stopping || pending.load() > 0; });
+                    if (stopping && pending.load() == 0)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                worker.jobs.fetch_add(1, std::memory_order_relaxed);
+                const auto begin = clock::now();
+                job(worker.state);
+                job = nullptr;
+                const auto elapsed = clock::now() - begin;
+                worker.busy.fetch_add(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                    std::memory_order_relaxed
+                );
+            }
+        }
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Context.hpp"
 #include "Ref.hpp"
 #include "error.hpp"
 
@@ -13,11 +14,19 @@ extern "C"
 #include <lua.h>
 }
 
+#include <array>
+#include <cstddef>
 #include <functional>
-#include <memory>
+#include <map>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <variant>
+#include <vector>
 
 /**
  * check - only used to check constructor arg type
@@ -30,44 +39,136 @@ extern "C"
 namespace nil::luax
 {
     template <typename T>
-    concept is_value_type                 //
-        = std::is_same_v<bool, T>         //
-        || std::is_integral_v<T>          //
-        || std::is_floating_point_v<T>    //
-        || std::is_same_v<const char*, T> //
-        || std::is_same_v<std::string, T> //
-        || std::is_same_v<std::string_view, T>;
+    concept is_value_type                      //
+        = std::is_same_v<bool, T>              //
+        || std::is_integral_v<T>               //
+        || std::is_floating_point_v<T>         //
+        || std::is_same_v<const char*, T>      //
+        || std::is_same_v<std::string, T>      //
+        || std::is_same_v<std::string_view, T> //
+        || std::is_same_v<std::span<const std::byte>, T>;
+
+    template <typename T>
+    struct is_std_array: std::false_type
+    {
+    };
+
+    template <typename T, std::size_t N>
+    struct is_std_array<std::array<T, N>>: std::true_type
+    {
+    };
+
+    /**
+     * converted from/to tables (or nil for an empty optional), see `Container.hpp`.
+     */
+    template <typename T>
+    concept is_container_type                            //
+        = xalt::is_of_template_v<T, std::vector>         //
+        || is_std_array<T>::value                        //
+        || xalt::is_of_template_v<T, std::map>           //
+        || xalt::is_of_template_v<T, std::unordered_map> //
+        || xalt::is_of_template_v<T, std::pair>          //
+        || xalt::is_of_template_v<T, std::optional>      //
+        || xalt::is_of_template_v<T, std::variant>;
 
     template <typename T>
     concept is_std_fn = xalt::is_of_template_v<T, std::function>;
 
+    template <typename T>
+    class Function;
+
+    template <typename T>
+    concept is_lua_fn = xalt::is_of_template_v<T, Function>;
+
     template <typename T>
     struct Meta;
 
     template <typename T>
     concept is_user_type = requires() { Meta<T>(); };
 
+    template <is_user_type T>
+    struct UserType;
+
     template <typename T>
     struct TypeDef;
 
+    template <typename R>
+    class Async;
+
+    template <typename T>
+    concept is_async = xalt::is_of_template_v<T, Async>;
+
+    template <typename R>
+    int push_async(lua_State* state, Async<R> async);
+
+    /**
+     * reads the arguments from the stack (starting at `first`), calls `fn` and pushes
+     * its result (one value per element for tuples).
+     * returns the number of values pushed.
+     */
+    template <typename R, typename... Args, std::size_t... I, typename F>
+    int call_and_push(
+        lua_State* state,
+        int first,
+        xalt::tlist<Args...> /* arg types */,
+        std::index_sequence<I...> /* arg indices */,
+        F&& fn
+    )
+    {
+        if constexpr (std::is_same_v<void, R>)
+        {
+            fn(TypeDef<Args>::value(state, first + int(I))...);
+            return 0;
+        }
+        else if constexpr (is_async<R>)
+        {
+            // `yield_request` when the thread has to wait for the result
+            return push_async(state, fn(TypeDef<Args>::value(state, first + int(I))...));
+        }
+        else if constexpr (nil::xalt::is_of_template_v<R, std::tuple>)
+        {
+            std::apply(
+                [&]<typename... V>(V&&... v)
+                { (TypeDef<std::remove_cvref_t<V>>::push(state, std::move(v)), ...); },
+                fn(TypeDef<Args>::value(state, first + int(I))...)
+            );
+            return std::tuple_size_v<R>;
+        }
+        else
+        {
+            TypeDef<R>::push(state, fn(TypeDef<Args>::value(state, first + int(I))...));
+            return 1;
+        }
+    }
+
     template <typename T>
     struct TypeDefCommon final
     {
-        static T pull(const std::shared_ptr<Ref>& ref)
+        static T pull(const Ref& ref)
         {
-            static_assert(is_value_type<std::decay_t<T>>);
-            auto* state = ref->push();
-            auto v = TypeDef<T>::value(state, -1);
-            lua_pop(state, 1);
-            return v;
+            static_assert(is_value_type<std::decay_t<T>> || is_container_type<std::decay_t<T>>);
+            auto* state = ref.push();
+            try
+            {
+                auto v = TypeDef<T>::value(state, -1);
+                lua_pop(state, 1);
+                return v;
+            }
+            catch (...)
+            {
+                lua_pop(state, 1);
+                throw;
+            }
         }
 
-        static decltype(auto) pull_closure(const std::shared_ptr<Ref>& ref)
+        static decltype(auto) pull_closure(const Ref& ref)
         {
-            auto* state = ref->push();
+            auto* state = ref.push();
             if (lua_iscfunction(state, -1) == 0)
             {
-                throw_error(state);
+                const auto type = lua_type(state, -1);
+                lua_pop(state, 1);
+                throw_type_error(state, "function", type);
             }
             lua_getupvalue(state, -1, 1);
             auto* value = static_cast<T*>(lua_touserdata(state, -1));
@@ -76,56 +177,37 @@ namespace nil::luax
             return *value;
         }
 
-        static void push_closure(lua_State* state, T context)
+        /**
+         * `name` identifies the closure in the instrumentation (defaults to the type name).
+         */
+        static void push_closure(lua_State* state, T context, std::string_view name = {})
         {
-            auto* data = static_cast<T*>(lua_newuserdata(state, sizeof(T)));
+            auto* data = static_cast<T*>(lua_newuserdatauv(state, sizeof(T), 0));
             new (data) T(std::move(context));
 
-            lua_newtable(state);
-            lua_pushcfunction(state, &TypeDefCommon<T>::del);
-            lua_setfield(state, -2, "__close");
+            // one metatable per closure type, shared by all closures of that type
+            auto& types = Context::from(state).types;
+            if (!types.template push_metatable<TypeDefCommon<T>>(state))
+            {
+                lua_createtable(state, 0, 1);
+                types.template set_metatable<TypeDefCommon<T>>(state);
+                lua_pushcfunction(state, &TypeDefCommon<T>::del);
+                lua_setfield(state, -2, "__gc");
+            }
             lua_setmetatable(state, -2);
 
-            constexpr auto closure_maker //
-                = []<typename... Args, std::size_t... I>(
-                      xalt::tlist<Args...> /* arg types */,
-                      std::index_sequence<I...> /* arg indices */
-                  )
+            if constexpr (instrumentation_enabled)
             {
-                return [](lua_State* s) -> int
-                {
-                    auto* user_data = static_cast<T*>(lua_touserdata(s, lua_upvalueindex(1)));
-
-                    using return_type = typename xalt::fn_sign<T>::return_type;
-                    if constexpr (std::is_same_v<void, return_type>)
-                    {
-                        (*user_data)(TypeDef<Args>::value(s, I + 1)...);
-                        return 0;
-                    }
-                    else if constexpr (nil::xalt::is_of_template_v<return_type, std::tuple>)
-                    {
-                        std::apply(
-                            [&]<typename... R>(R&&... r)
-                            { (TypeDef<std::remove_cvref_t<R>>::push(s, std::move(r)), ...); },
-                            (*user_data)(TypeDef<Args>::value(s, I + 1)...)
-                        );
-                        return std::tuple_size_v<return_type>;
-                    }
-                    else
-                    {
-                        TypeDef<return_type>::push(
-                            s,
-                            (*user_data)(TypeDef<Args>::value(s, I + 1)...)
-                        );
-                        return 1;
-                    }
-                };
-            };
-            constexpr auto closure = closure_maker(
-                typename xalt::fn_sign<T>::arg_types(),
-                std::make_index_sequence<xalt::fn_sign<T>::arg_types::size>()
-            );
-            lua_pushcclosure(state, closure, 1);
+                auto& instrumentation = Context::from(state).instrumentation;
+                const auto slot
+                    = instrumentation.slot(name.empty() ? xalt::str_name_v<T> : name);
+                lua_pushinteger(state, lua_Integer(slot));
+                lua_pushcclosure(state, &protect<&TypeDefCommon<T>::call_instrumented>, 2);
+            }
+            else
+            {
+                lua_pushcclosure(state, &protect<&TypeDefCommon<T>::call>, 1);
+            }
         }
 
         static int del(lua_State* state)
@@ -133,6 +215,36 @@ namespace nil::luax
             static_cast<T*>(lua_touserdata(state, 1))->~T();
             return 0;
         }
+
+    private:
+        /**
+         * [upvalue 1] - userdata holding the callable
+         * [upvalue 2] - instrumentation slot
+         */
+        static int call_instrumented(lua_State* state)
+        {
+            const auto slot = std::size_t(lua_tointeger(state, lua_upvalueindex(2)));
+            return Context::from(state).instrumentation.measure(
+                slot,
+                [state]() { return call(state); }
+            );
+        }
+
+        /**
+         * [upvalue 1] - userdata holding the callable
+         */
+        static int call(lua_State* state)
+        {
+            auto* user_data = static_cast<T*>(lua_touserdata(state, lua_upvalueindex(1)));
+            using sign = xalt::fn_sign<T>;
+            return call_and_push<typename sign::return_type>(
+                state,
+                1,
+                typename sign::arg_types(),
+                std::make_index_sequence<sign::arg_types::size>(),
+                *user_data
+            );
+        }
     };
 
     template <>
@@ -147,7 +259,7 @@ namespace nil::luax
         {
             if (!check(state, index))
             {
-                throw_error(state);
+                throw_type_error(state, "boolean", lua_type(state, index));
             }
             return lua_toboolean(state, index) > 0;
         }
@@ -157,7 +269,7 @@ namespace nil::luax
             lua_pushboolean(state, value ? 1 : 0);
         }
 
-        static auto pull(const std::shared_ptr<Ref>& ref)
+        static auto pull(const Ref& ref)
         {
             return TypeDefCommon<bool>::pull(ref);
         }
@@ -174,11 +286,14 @@ namespace nil::luax
 
         static T value(lua_State* state, int index)
         {
-            if (!check(state, index))
+            // same as check + lua_tonumber in one call
+            int is_number = 0;
+            const auto number = lua_tonumberx(state, index, &is_number);
+            if (is_number == 0)
             {
-                throw_error(state);
+                throw_type_error(state, xalt::str_name_v<T>, lua_type(state, index));
             }
-            return T(lua_tonumber(state, index));
+            return T(number);
         }
 
         static void push(lua_State* state, T value)
@@ -186,7 +301,7 @@ namespace nil::luax
             lua_pushnumber(state, value);
         }
 
-        static auto pull(const std::shared_ptr<Ref>& ref)
+        static auto pull(const Ref& ref)
         {
             return TypeDefCommon<T>::pull(ref);
         }
@@ -205,17 +320,17 @@ namespace nil::luax
         {
             if (!check(state, index))
             {
-                throw_error(state);
+                throw_type_error(state, xalt::str_name_v<T>, lua_type(state, index));
             }
             return T(lua_tointeger(state, index));
         }
 
         static void push(lua_State* state, T value)
         {
-            lua_pushinteger(state, value);
+            lua_pushinteger(state, lua_Integer(value));
         }
 
-        static auto pull(const std::shared_ptr<Ref>& ref)
+        static auto pull(const Ref& ref)
         {
             return TypeDefCommon<T>::pull(ref);
         }
@@ -230,20 +345,34 @@ namespace nil::luax
             return lua_isstring(state, index) != 0;
         }
 
-        static auto value(lua_State* state, int index)
+        /**
+         * the content is not copied for `std::string_view` and `const char*`,
+         * it is only valid while the lua string is (for arguments: during the call).
+         */
+        static T value(lua_State* state, int index)
         {
-            if (!check(state, index))
+            std::size_t size = 0;
+            const char* data = lua_tolstring(state, index, &size);
+            if (data == nullptr)
+            {
+                throw_type_error(state, "string", lua_type(state, index));
+            }
+            if constexpr (std::is_same_v<const char*, T>)
+            {
+                return data;
+            }
+            else
             {
-                throw_error(state);
+                // keeps embedded zeros
+                return T(data, size);
             }
-            return T(lua_tostring(state, index));
         }
 
         static void push(lua_State* state, const T& value)
         {
             if constexpr (std::is_same_v<const char*, T>)
             {
-                lua_pushlstring(state, value);
+                lua_pushstring(state, value);
             }
             else
             {
@@ -251,7 +380,7 @@ namespace nil::luax
             }
         }
 
-        static auto pull(const std::shared_ptr<Ref>& ref)
+        static auto pull(const Ref& ref)
         {
             return TypeDefCommon<std::string>::pull(ref);
         }
@@ -271,72 +400,19 @@ namespace nil::luax
         {
             if (!check(state, index))
             {
-                throw_error(state);
+                throw_type_error(state, "function", lua_type(state, index));
             }
             lua_pushvalue(state, index);
-            auto ref = std::make_shared<Ref>(state);
-            return pull(ref);
+            return std::function<R(Args...)>(Function<R(Args...)>(Ref(state)));
         }
 
-        static auto pull(const std::shared_ptr<Ref>& ref)
+        static auto pull(const Ref& ref)
         {
             // pulling std::function needs to use lua api since
             // i can't guarantee if the content of the upvalue is
             // an std::function. user side might store a lambda
             // but then get an std::function out of it.
-
-            // either to store everything in terms of std::function
-            // to the upvalues, or use lua api to call the method
-            return std::function<R(Args...)>(
-                [ref](Args... args)
-                {
-                    auto* state = ref->push();
-                    if (!lua_isfunction(state, -1))
-                    {
-                        throw_error(state);
-                    }
-
-                    (TypeDef<Args>::push(state, static_cast<Args>(args)), ...);
-
-                    if constexpr (std::is_same_v<R, void>)
-                    {
-                        if (lua_pcall(state, sizeof...(Args), 0, 0) != LUA_OK)
-                        {
-                            throw_error(state);
-                        }
-                    }
-                    else if constexpr (nil::xalt::is_of_template_v<R, std::tuple>)
-                    {
-                        if (lua_pcall(state, sizeof...(Args), std::tuple_size_v<R>, 0) != LUA_OK)
-                        {
-                            throw_error(state);
-                        }
-                        R return_value;
-                        constexpr std::size_t N = std::tuple_size_v<R>;
-                        [&]<std::size_t... I>(std::index_sequence<I...>)
-                        {
-                            ((std::get<I>(return_value)
-                              = TypeDef<std::remove_cvref_t<std::tuple_element_t<I, R>>>::value(
-                                  state,
-                                  -int(N - I)
-                              )),
-                             ...);
-                        }(std::make_index_sequence<N>{});
-                        lua_pop(state, int(N));
-                        return return_value;
-                    }
-                    else
-                    {
-                        if (lua_pcall(state, sizeof...(Args), 1, 0) != LUA_OK)
-                        {
-                            throw_error(state);
-                        }
-                        auto value = TypeDef<R>::value(state, -1);
-                        lua_pop(state, 1);
-                        return value;
-                    }
-                }
-            );
+            return std::function<R(Args...)>(TypeDef<Function<R(Args...)>>::pull(ref));
         }
 
         static void push(lua_State* state, std::function<R(Args...)> callable)
@@ -351,14 +427,16 @@ namespace nil::luax
     struct TypeDef<R(Args...)> final
     {
         // no push since users should not push this
-        static auto pull(const std::shared_ptr<Ref>& ref)
+        static auto pull(const Ref& ref)
         {
             return TypeDef<std::function<R(Args...)>>::pull(ref);
         }
     };
 
     template <typename T>
-        requires(!is_value_type<std::remove_cvref_t<T>>) && (!is_user_type<std::remove_cvref_t<T>>)
+        requires(!is_value_type<std::remove_cvref_t<T>>)     //
+                && (!is_user_type<std::remove_cvref_t<T>>) //
+                && (!is_container_type<std::remove_cvref_t<T>>)
     struct TypeDef<T> final
     {
         static void push(lua_State* state, T callable)
@@ -366,7 +444,7 @@ namespace nil::luax
             TypeDefCommon<T>::push_closure(state, std::move(callable));
         }
 
-        static auto& pull(const std::shared_ptr<Ref>& ref)
+        static auto& pull(const Ref& ref)
         {
             return TypeDefCommon<T>::pull_closure(ref);
         }
@@ -382,16 +460,15 @@ namespace nil::luax
 
         static bool check(lua_State* state, int index)
         {
-            return luaL_testudata(state, index, xalt::str_name_v<raw_type>) != nullptr;
+            return UserType<raw_type>::to(state, index) != nullptr;
         }
 
         static raw_type& value(lua_State* state, int index)
         {
-            auto* data
-                = static_cast<raw_type*>(luaL_testudata(state, index, xalt::str_name_v<raw_type>));
+            auto* data = UserType<raw_type>::to(state, index);
             if (data == nullptr)
             {
-                throw_error(state);
+                throw_type_error(state, xalt::str_name_v<raw_type>, lua_type(state, index));
             }
             return *data;
         }
@@ -401,30 +478,35 @@ namespace nil::luax
             static_assert(!std::is_const_v<std::remove_reference_t<T>>);
             if constexpr (std::is_reference_v<T>)
             {
-                lua_pushlightuserdata(state, &value);
+                UserType<raw_type>::push_ref(state, value);
             }
             else
             {
-                auto* data = static_cast<raw_type*>(lua_newuserdata(state, sizeof(raw_type)));
-                new (data) raw_type(std::move(value));
+                UserType<raw_type>::push_value(state, std::move(value));
             }
-            luaL_getmetatable(state, xalt::str_name_v<raw_type>);
-            lua_setmetatable(state, -2);
         }
 
-        static auto& pull(const std::shared_ptr<Ref>& ref)
+        static auto& pull(const Ref& ref)
         {
-            auto* state = ref->push();
-            auto* ptr = static_cast<raw_type*>(lua_touserdata(state, -1));
+            auto* state = ref.push();
+            auto* data = UserType<raw_type>::to(state, -1);
+            const auto type = lua_type(state, -1);
             lua_pop(state, 1);
-            return *ptr;
+            if (data == nullptr)
+            {
+                throw_type_error(state, xalt::str_name_v<raw_type>, type);
+            }
+            return *data;
         }
     };
 
     // ref support
 
     template <typename T>
-        requires(is_value_type<std::remove_cvref_t<T>> || xalt::is_of_template_v<std::remove_cvref_t<T>, std::function>)
+        requires(is_value_type<std::remove_cvref_t<T>>    //
+                 || is_std_fn<std::remove_cvref_t<T>>     //
+                 || is_lua_fn<std::remove_cvref_t<T>>     //
+                 || is_container_type<std::remove_cvref_t<T>>)
     struct TypeDef<T&> final
     {
         using raw_type = std::remove_cvref_t<T>;
@@ -444,7 +526,7 @@ namespace nil::luax
             TypeDef<raw_type>::push(state, value);
         }
 
-        static decltype(auto) pull(const std::shared_ptr<Ref>& ref)
+        static decltype(auto) pull(const Ref& ref)
         {
             return TypeDef<raw_type>::pull(ref);
         }
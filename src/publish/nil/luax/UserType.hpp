@@ -1,6 +1,9 @@
 #pragma once
 
+#include "Context.hpp"
+#include "Overload.hpp"
 #include "TypeDef.hpp"
+#include "error.hpp"
 
 #include <nil/xalt/fn_sign.hpp>
 #include <nil/xalt/literal.hpp>
@@ -13,6 +16,15 @@ extern "C"
 #include <lua.h>
 }
 
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
 namespace nil::luax
@@ -37,44 +49,428 @@ namespace nil::luax
     {
     };
 
+    constexpr auto hash_fnv1a(
+        std::string_view literal,                 // NOLINT
+        std::uint32_t offset_basis = 0x811C9DC5u, // NOLINT
+        std::uint32_t prime = 0x01000193          // NOLINT
+    ) -> std::uint32_t
+    {
+        std::uint32_t hash = offset_basis;
+        for (auto i : literal)
+        {
+            hash ^= static_cast<std::uint8_t>(i);
+            hash *= prime;
+        }
+        return hash;
+    }
+
+    /**
+     * Perfect hash of the member names of `Meta<T>::Members`, built at compile time.
+     *
+     * Names are hashed once with fnv1a and distributed to buckets. Each bucket gets a
+     * displacement that moves all of its names to free slots (hash and displace).
+     * A lookup is one hash of the key, two array reads and one string compare,
+     * regardless of the number of members.
+     */
+    template <typename Members>
+    struct MemberTable;
+
+    template <typename... M>
+    struct MemberTable<List<M...>> final
+    {
+    private:
+        template <xalt::literal l, auto p>
+        static consteval std::string_view name_of(Property<l, p> /* member */)
+        {
+            return xalt::literal_v<l>;
+        }
+
+        template <xalt::literal l, auto p>
+        static consteval std::string_view name_of(Method<l, p> /* member */)
+        {
+            return xalt::literal_v<l>;
+        }
+
+    public:
+        static constexpr std::size_t size = sizeof...(M);
+        static constexpr std::array<std::string_view, size> names = {name_of(M())...};
+
+    private:
+        static constexpr std::size_t bucket_count = std::bit_ceil(size == 0 ? 1 : size);
+        static constexpr std::size_t slot_bits = std::bit_width(2 * bucket_count) - 1;
+        static constexpr std::size_t slot_count = std::size_t(1) << slot_bits;
+        static constexpr std::uint16_t empty = 0xFFFFu;
+
+        static_assert(size < empty, "too many members");
+
+        static constexpr std::size_t slot_of(std::uint32_t hash, std::uint32_t displacement)
+        {
+            const std::uint32_t mixed = (hash ^ (displacement * 0x9E3779B9u)) * 0x85EBCA6Bu;
+            return std::size_t(mixed >> (32u - slot_bits));
+        }
+
+        struct Layout
+        {
+            std::array<std::uint32_t, bucket_count> displacements = {};
+            std::array<std::uint16_t, slot_count> slots = {};
+        };
+
+        static consteval Layout make_layout()
+        {
+            std::array<std::uint32_t, size> hashes = {};
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                hashes[i] = hash_fnv1a(names[i]);
+                for (std::size_t j = 0; j < i; ++j)
+                {
+                    if (names[i] == names[j])
+                    {
+                        throw "duplicate member name";
+                    }
+                    if (hashes[i] == hashes[j])
+                    {
+                        throw "member names with colliding hashes";
+                    }
+                }
+            }
+
+            Layout layout;
+            layout.slots.fill(empty);
+
+            std::array<std::size_t, bucket_count> bucket_sizes = {};
+            for (const auto hash : hashes)
+            {
+                ++bucket_sizes[hash & (bucket_count - 1)];
+            }
+
+            // place the crowded buckets first while most slots are still free
+            for (std::size_t count = size; count > 0; --count)
+            {
+                for (std::size_t bucket = 0; bucket < bucket_count; ++bucket)
+                {
+                    if (bucket_sizes[bucket] != count)
+                    {
+                        continue;
+                    }
+
+                    for (std::uint32_t displacement = 0;; ++displacement)
+                    {
+                        if (displacement == 0x10000u)
+                        {
+                            throw "unable to build a perfect hash for the member names";
+                        }
+
+                        std::array<std::uint16_t, slot_count> slots = layout.slots;
+                        bool placed = true;
+                        for (std::size_t i = 0; i < size && placed; ++i)
+                        {
+                            if ((hashes[i] & (bucket_count - 1)) != bucket)
+                            {
+                                continue;
+                            }
+                            auto& slot = slots[slot_of(hashes[i], displacement)];
+                            placed = slot == empty;
+                            slot = std::uint16_t(i);
+                        }
+
+                        if (placed)
+                        {
+                            layout.slots = slots;
+                            layout.displacements[bucket] = displacement;
+                            break;
+                        }
+                    }
+                }
+            }
+            return layout;
+        }
+
+        static constexpr Layout layout = make_layout();
+
+    public:
+        /**
+         * returns the index of the member named `key` or `size` if there is none
+         */
+        static constexpr std::size_t find(std::string_view key)
+        {
+            const auto hash = hash_fnv1a(key);
+            const auto displacement = layout.displacements[hash & (bucket_count - 1)];
+            const auto index = layout.slots[slot_of(hash, displacement)];
+            if (index != empty && names[index] == key)
+            {
+                return index;
+            }
+            return size;
+        }
+    };
+
+    template <typename M>
+    constexpr bool is_method = false;
+
+    template <xalt::literal l, auto p>
+    constexpr bool is_method<Method<l, p>> = true;
+
+    template <typename T>
+    struct MembersOf
+    {
+        using type = List<>;
+    };
+
+    template <typename T>
+        requires requires() { typename Meta<T>::Members; }
+    struct MembersOf<T>
+    {
+        using type = typename Meta<T>::Members;
+    };
+
+    /**
+     * user types with elements, opted in with `static constexpr bool indexed = true` in `Meta<T>`.
+     * `T` provides `size()` and `operator[](std::size_t)` (const elements are read only).
+     * lua sees the elements at `1..size()` through `[]`, `#`, `ipairs` and `pairs`,
+     * other keys are resolved as members.
+     */
+    template <typename T>
+    concept is_indexed = requires(T& value, std::size_t i) {
+        requires Meta<T>::indexed;
+        { value.size() } -> std::convertible_to<std::size_t>;
+        value[i];
+    };
+
     template <is_user_type T>
     struct UserType
     {
+    private:
+        using members = typename MembersOf<T>::type;
+        using table = MemberTable<members>;
+
+        static constexpr std::size_t method_count = []<typename... M>(List<M...>)
+        { return (std::size_t(0) + ... + std::size_t(is_method<M> ? 1 : 0)); }(members());
+
+        /**
+         * userdata of T starts with a header.
+         *  - owned values are stored right after the header.
+         *  - references only have the header.
+         * `data` is reset once an owned value is destroyed.
+         * `tag` identifies T without looking up the metatable.
+         */
+        struct Header
+        {
+            T* data;
+            const void* tag;
+        };
+
+        static constexpr char tag = 0;
+
+        static constexpr std::size_t value_offset
+            = (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+
     public:
+        /**
+         * pushes the metatable of T, building and registering it on first use.
+         */
+        static void push_metatable(lua_State* state)
+        {
+            auto& types = Context::from(state).types;
+            if (types.template push_metatable<T>(state))
+            {
+                return;
+            }
+
+            lua_newtable(state);
+            types.template set_metatable<T>(state);
+            lua_pushstring(state, xalt::str_name_v<T>);
+            lua_setfield(state, -2, "__name");
+            lua_pushcfunction(state, &UserType<T>::type_close);
+            lua_setfield(state, -2, "__close");
+            lua_pushcfunction(state, &UserType<T>::type_close);
+            lua_setfield(state, -2, "__gc");
+            if constexpr (requires() { &T::operator(); })
+            {
+                lua_pushcfunction(state, &protect<&UserType<T>::type_call>);
+                lua_setfield(state, -2, "__call");
+            }
+            if constexpr (is_indexed<T>)
+            {
+                push_methods(state);
+                lua_pushcclosure(state, &protect<&UserType<T>::type_element_index>, 1);
+                lua_setfield(state, -2, "__index");
+                lua_pushcfunction(state, &protect<&UserType<T>::type_element_newindex>);
+                lua_setfield(state, -2, "__newindex");
+                lua_pushcfunction(state, &protect<&UserType<T>::type_len>);
+                lua_setfield(state, -2, "__len");
+                lua_pushcfunction(state, &protect<&UserType<T>::type_element_pairs>);
+                lua_setfield(state, -2, "__pairs");
+            }
+            else if constexpr (requires() { typename Meta<T>::Members; })
+            {
+                push_methods(state);
+                if constexpr (has_properties)
+                {
+                    lua_pushcclosure(state, &protect<&UserType<T>::type_index>, 1);
+                }
+                else
+                {
+                    // the methods table is `__index` itself, its misses are unknown members
+                    lua_createtable(state, 0, 1);
+                    lua_pushcfunction(state, &protect<&UserType<T>::type_unknown_member>);
+                    lua_setfield(state, -2, "__index");
+                    lua_setmetatable(state, -2);
+                }
+                lua_setfield(state, -2, "__index");
+                lua_pushcfunction(state, &protect<&UserType<T>::type_newindex>);
+                lua_setfield(state, -2, "__newindex");
+                lua_pushcfunction(state, &protect<&UserType<T>::type_pairs>);
+                lua_setfield(state, -2, "__pairs");
+            }
+            // TODO:
+            //  -  __tostring
+            //  -  __concat
+        }
+
+        /**
+         * returns the object if the value at `index` is a live T, nullptr otherwise.
+         */
+        static T* to(lua_State* state, int index)
+        {
+            auto* header = static_cast<Header*>(lua_touserdata(state, index));
+            if (header == nullptr || lua_rawlen(state, index) < sizeof(Header)
+                || header->tag != &tag)
+            {
+                return nullptr;
+            }
+            return header->data;
+        }
+
+        template <typename... Args>
+        static T& push_value(lua_State* state, Args&&... args)
+        {
+            auto* block = static_cast<std::byte*>(
+                lua_newuserdatauv(state, value_offset + sizeof(T), 0) //
+            );
+            auto* header = new (block) Header{nullptr, &tag};
+            header->data = new (block + value_offset) T(std::forward<Args>(args)...);
+            push_metatable(state);
+            lua_setmetatable(state, -2);
+            return *header->data;
+        }
+
+        /**
+         * userdata for references are cached (weakly) by address
+         * so that passing the same object repeatedly does not allocate.
+         */
+        static void push_ref(lua_State* state, T& value)
+        {
+            auto& types = Context::from(state).types;
+            if (!types.template has_ref_cache<T>())
+            {
+                push_metatable(state);
+                lua_pop(state, 1);
+            }
+            types.template push_ref_cache<T>(state);
+            if (lua_rawgetp(state, -1, &value) != LUA_TUSERDATA)
+            {
+                lua_pop(state, 1);
+                new (lua_newuserdatauv(state, sizeof(Header), 0)) Header{&value, &tag};
+                types.template push_metatable<T>(state);
+                lua_setmetatable(state, -2);
+                lua_pushvalue(state, -1);
+                lua_rawsetp(state, -3, &value);
+            }
+            lua_remove(state, -2);
+        }
+
         static int type_constructors(lua_State* state)
         {
-            type_constructor(state, typename Meta<T>::Constructors());
+            using overloads = decltype(constructor_overloads(typename Meta<T>::Constructors()));
+            if (overloads::call(state, 1, lua_gettop(state)) == overloads::no_match)
+            {
+                throw_user_error("can't be constructed with the provided arguments");
+            }
             return 1;
         }
 
+        /**
+         * used for both `__close` and `__gc`.
+         * only owned values are destroyed and only once.
+         */
         static int type_close(lua_State* state)
         {
-            static_cast<T*>(lua_touserdata(state, 1))->~T();
+            if (lua_rawlen(state, 1) > sizeof(Header))
+            {
+                auto* header = static_cast<Header*>(lua_touserdata(state, 1));
+                if (T* data = std::exchange(header->data, nullptr))
+                {
+                    data->~T();
+                }
+            }
             return 0;
         }
 
+    private:
+        /**
+         * pushes a table of all `Method` members bound to their trampolines.
+         * this is meant to be built once per metatable so that method lookups
+         * are resolved by the vm without calling `type_index`.
+         */
+        static void push_methods(lua_State* state)
+        {
+            lua_createtable(state, 0, int(method_count));
+            push_methods(state, members());
+        }
+
+        static constexpr bool has_properties = method_count < table::size;
+
+        /**
+         * [upvalue 1] - table created by `push_methods`
+         */
         static int type_index(lua_State* state)
         {
-            T* data = static_cast<T*>(luaL_testudata(state, 1, xalt::str_name_v<T>));
+            lua_pushvalue(state, 2);
+            if (lua_rawget(state, lua_upvalueindex(1)) != LUA_TNIL)
+            {
+                return 1;
+            }
+            lua_pop(state, 1);
+
+            T* data = to(state, 1);
             if (data == nullptr)
             {
-                luaL_error(state, "[%s] is of different type", xalt::str_name_v<T>);
+                throw_user_error("is of different type");
+            }
+            const auto key = check_key(state);
+            const auto index = table::find(key);
+            if (index == table::size)
+            {
+                throw_user_error("member [" + std::string(key) + "] is unknown");
             }
-            const char* key = luaL_checkstring(state, 2);
-            type_get_members(state, typename Meta<T>::Members(), data, key, hash_fnv1a(key));
+            member_getters[index](state, data);
             return 1;
         }
 
+        /**
+         * `__index` of the methods table when T has no properties.
+         * [1] - methods table, [2] - key
+         */
+        static int type_unknown_member(lua_State* state)
+        {
+            throw_user_error("member [" + std::string(check_key(state)) + "] is unknown");
+        }
+
         static int type_newindex(lua_State* state)
         {
-            T* data = static_cast<T*>(luaL_testudata(state, 1, xalt::str_name_v<T>));
+            T* data = to(state, 1);
             if (data == nullptr)
             {
-                luaL_error(state, "[%s] is of different type", xalt::str_name_v<T>);
+                throw_user_error("is of different type");
             }
-            const char* key = luaL_checkstring(state, 2);
-            type_set_members(state, typename Meta<T>::Members(), data, key, hash_fnv1a(key));
-            return 1;
+            const auto key = check_key(state);
+            const auto index = table::find(key);
+            if (index == table::size)
+            {
+                throw_user_error("member [" + std::string(key) + "] is unknown");
+            }
+            member_setters[index](state, data);
+            return 0;
         }
 
         static int type_call(lua_State* state)
@@ -84,60 +480,175 @@ namespace nil::luax
 
         static int type_pairs(lua_State* state)
         {
-            lua_pushcfunction(
-                state,
-                [](lua_State* ss)
-                {
-                    T* data = static_cast<T*>(luaL_testudata(ss, 1, xalt::str_name_v<T>));
-                    if (lua_isnil(ss, 2))
-                    {
-                        return type_pairs_iter(ss, typename Meta<T>::Members(), data, nullptr);
-                    }
-                    const auto hash = hash_fnv1a(lua_tostring(ss, 2));
-                    return type_pairs_iter(ss, typename Meta<T>::Members(), data, &hash);
-                }
-            );
-            lua_pushlightuserdata(state, luaL_testudata(state, 1, xalt::str_name_v<T>));
-            luaL_getmetatable(state, xalt::str_name_v<T>);
-            lua_setmetatable(state, -2);
+            lua_pushcfunction(state, &protect<&UserType<T>::type_next>);
+            lua_pushvalue(state, 1);
             lua_pushnil(state);
             return 3;
         }
 
-    private:
-        template <typename... CType, typename... TRest>
-        static void type_constructor(
-            lua_State* state,
-            List<Constructor<CType...>, TRest...> /* constructors */
-        )
+        static int type_next(lua_State* state)
         {
-            constexpr auto match = []<std::size_t... I>(lua_State* ss, std::index_sequence<I...>)
+            T* data = to(state, 1);
+            if (data == nullptr)
             {
-                if (sizeof...(CType) == lua_gettop(ss)
-                    && (true && ... && TypeDef<CType>::check(ss, I + 1)))
-                {
-                    T* data = static_cast<T*>(lua_newuserdata(ss, sizeof(T)));
-                    new (data) T(TypeDef<CType>::value(ss, I + 1)...);
-                    luaL_getmetatable(ss, xalt::str_name_v<T>);
-                    lua_setmetatable(ss, -2);
-                    return false;
-                }
-                return true;
-            };
+                throw_user_error("is of different type");
+            }
+            const auto index = lua_isnil(state, 2) ? 0 : table::find(check_key(state)) + 1;
+            if (index >= table::size)
+            {
+                return 0;
+            }
+            const auto name = table::names[index];
+            lua_pushlstring(state, name.data(), name.size());
+            member_getters[index](state, data);
+            return 2;
+        }
 
-            if (match(state, std::make_index_sequence<sizeof...(CType)>()))
+        /**
+         * integer keys are elements (nil when out of range, like a table),
+         * other keys are members.
+         * [upvalue 1] - table created by `push_methods`
+         */
+        static int type_element_index(lua_State* state)
+        {
+            if (lua_type(state, 2) != LUA_TNUMBER)
             {
-                if constexpr (sizeof...(TRest) == 0)
-                {
-                    luaL_error(state, "[%s] can't be constructed with the provided arguments", xalt::str_name_v<T>);
-                }
-                else
+                return type_index(state);
+            }
+            T* data = to(state, 1);
+            if (data == nullptr)
+            {
+                throw_user_error("is of different type");
+            }
+            const auto position = check_position(state);
+            if (position < 1 || position > lua_Integer(data->size()))
+            {
+                lua_pushnil(state);
+                return 1;
+            }
+            push_element(state, (*data)[std::size_t(position - 1)]);
+            return 1;
+        }
+
+        static int type_element_newindex(lua_State* state)
+        {
+            if (lua_type(state, 2) != LUA_TNUMBER)
+            {
+                return type_newindex(state);
+            }
+            T* data = to(state, 1);
+            if (data == nullptr)
+            {
+                throw_user_error("is of different type");
+            }
+            using reference = decltype((*data)[std::size_t()]);
+            if constexpr (std::is_const_v<std::remove_reference_t<reference>>)
+            {
+                throw_user_error("is read only");
+            }
+            else
+            {
+                const auto position = check_position(state);
+                const auto size = lua_Integer(data->size());
+                if (position < 1 || position > size)
                 {
-                    type_constructor(state, List<TRest...>());
+                    throw_user_error(
+                        "index [" + std::to_string(position) + "] is out of range [1, "
+                        + std::to_string(size) + "]"
+                    );
                 }
+                using element_type = std::remove_cvref_t<reference>;
+                (*data)[std::size_t(position - 1)] = TypeDef<element_type>::value(state, 3);
+                return 0;
             }
         }
 
+        static int type_len(lua_State* state)
+        {
+            T* data = to(state, 1);
+            if (data == nullptr)
+            {
+                throw_user_error("is of different type");
+            }
+            lua_pushinteger(state, lua_Integer(data->size()));
+            return 1;
+        }
+
+        static int type_element_pairs(lua_State* state)
+        {
+            lua_pushcfunction(state, &protect<&UserType<T>::type_element_next>);
+            lua_pushvalue(state, 1);
+            lua_pushinteger(state, 0);
+            return 3;
+        }
+
+        static int type_element_next(lua_State* state)
+        {
+            T* data = to(state, 1);
+            if (data == nullptr)
+            {
+                throw_user_error("is of different type");
+            }
+            const auto position = lua_tointeger(state, 2) + 1;
+            if (position > lua_Integer(data->size()))
+            {
+                return 0;
+            }
+            lua_pushinteger(state, position);
+            push_element(state, (*data)[std::size_t(position - 1)]);
+            return 2;
+        }
+
+        /**
+         * user types are pushed as references into the container (unless const).
+         */
+        template <typename R>
+        static void push_element(lua_State* state, R&& element)
+        {
+            using raw_type = std::remove_cvref_t<R>;
+            if constexpr (is_user_type<raw_type> && !std::is_const_v<std::remove_reference_t<R>>)
+            {
+                TypeDef<raw_type&>::push(state, element);
+            }
+            else
+            {
+                TypeDef<raw_type>::push(state, element);
+            }
+        }
+
+        static lua_Integer check_position(lua_State* state)
+        {
+            int is_integer = 0;
+            const auto position = lua_tointegerx(state, 2, &is_integer);
+            if (is_integer == 0)
+            {
+                throw_type_error(state, "integer", lua_type(state, 2));
+            }
+            return position;
+        }
+
+        template <typename Ctor>
+        struct ConstructorCall;
+
+        template <typename... CType>
+        struct ConstructorCall<Constructor<CType...>>
+        {
+            using arg_types = xalt::tlist<CType...>;
+
+            static int call(lua_State* state, int first)
+            {
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                { push_value(state, TypeDef<CType>::value(state, first + int(I))...); }(
+                    std::make_index_sequence<sizeof...(CType)>()
+                );
+                return 1;
+            }
+        };
+
+        template <typename... Ctor>
+        static auto constructor_overloads(List<Ctor...> /* constructors */)
+            -> Overloads<ConstructorCall<Ctor>...>;
+
         template <auto member>
         static int type_method_call(lua_State* state)
         {
@@ -149,11 +660,15 @@ namespace nil::luax
                      std::size_t... I> //
                 (lua_State * ss, xalt::tlist<Args...>, std::index_sequence<I...>)
             {
-                T* data = static_cast<T*>(lua_touserdata(ss, 1));
+                T* data = to(ss, 1);
+                if (data == nullptr)
+                {
+                    throw_user_error("is of different type");
+                }
                 using R = typename fn_sign::return_type;
                 if constexpr (!std::is_same_v<void, R>)
                 {
-                    TypeDef<R>::push((data->*member)(TypeDef<Args>::value(ss, I + 2)...));
+                    TypeDef<R>::push(ss, (data->*member)(TypeDef<Args>::value(ss, I + 2)...));
                     return 1;
                 }
                 else
@@ -166,169 +681,132 @@ namespace nil::luax
             return fn(state, Args(), std::make_index_sequence<Args::size>());
         }
 
-        template <xalt::literal l, auto p>
-        static void type_get_key(lua_State* state, Method<l, p> /* member */)
+        /**
+         * runs `fn`, measured as `type.member` + `suffix` if instrumentation is compiled in.
+         * `type` is the name given to `State::add_type`, or the c++ name of T without one.
+         * `Key` identifies the member.
+         */
+        template <typename Key, xalt::literal l, typename F>
+        static decltype(auto) measured(lua_State* state, std::string_view suffix, F&& fn)
         {
-            lua_pushstring(state, nil::xalt::literal_v<l>);
+            if constexpr (instrumentation_enabled)
+            {
+                auto& instrumentation = Context::from(state).instrumentation;
+                const auto slot = instrumentation.template slot<Key>(
+                    [state, suffix]()
+                    {
+                        auto name = Context::from(state).types.template name<T>();
+                        if (name.empty())
+                        {
+                            name = xalt::str_name_v<T>;
+                        }
+                        return std::string(name) + "." + xalt::literal_v<l> + std::string(suffix);
+                    }
+                );
+                return instrumentation.measure(slot, std::forward<F>(fn));
+            }
+            else
+            {
+                return fn();
+            }
         }
 
         template <xalt::literal l, auto p>
-        static void type_get_key(lua_State* state, Property<l, p> /* member */)
+        static int type_method(lua_State* state)
         {
-            lua_pushstring(state, nil::xalt::literal_v<l>);
+            return measured<Method<l, p>, l>(
+                state,
+                "",
+                [state]() { return type_method_call<p>(state); }
+            );
         }
 
         template <xalt::literal l, auto p>
         static void type_get_member(lua_State* state, Method<l, p> /* member */, T* /* data */)
         {
-            lua_pushcfunction(state, &type_method_call<p>);
+            lua_pushcfunction(state, (&protect<&type_method<l, p>>));
         }
 
         template <xalt::literal l, auto p>
         static void type_get_member(lua_State* state, Property<l, p> /* member */, T* data)
         {
-            TypeDef<decltype(data->*p)>::push(state, data->*p);
-        }
-
-        template <typename M, typename... TRest>
-        static void type_get_members(
-            lua_State* state,
-            List<M, TRest...> /* props */,
-            T* data,
-            const char* key,
-            std::uint32_t key_hash
-        )
-        {
-            static constinit auto hash = hash_fnv1a(M());
-            if (key_hash == hash)
-            {
-                type_get_member(state, M(), data);
-            }
-            else
-            {
-                type_get_members(state, List<TRest...>(), data, key, key_hash);
-            }
+            measured<Property<l, p>, l>(
+                state,
+                " [get]",
+                [state, data]() { TypeDef<decltype(data->*p)>::push(state, data->*p); }
+            );
         }
 
         template <xalt::literal l, auto p>
-        static void type_set_member(lua_State* state, Method<l, p> /* member */, T* /* data */)
+        static void type_set_member(
+            lua_State* /* state */,
+            Method<l, p> /* member */,
+            T* /* data */
+        )
         {
-            luaL_error(state, "[%s] member functions are not be replaceable", xalt::str_name_v<T>);
+            throw_user_error("member functions are not be replaceable");
         }
 
         template <xalt::literal l, auto p>
         static void type_set_member(lua_State* state, Property<l, p> /* member */, T* data)
         {
-            data->*p = TypeDef<decltype(data->*p)>::value(state, 3);
-        }
-
-        template <typename M, typename... TRest>
-        static void type_set_members(
-            lua_State* state,
-            List<M, TRest...> /* props */,
-            T* data,
-            const char* key,
-            std::uint32_t key_hash
-        )
-        {
-            static constinit auto hash = hash_fnv1a(M());
-            if (key_hash == hash)
-            {
-                type_set_member(state, M(), data);
-            }
-            else
-            {
-                type_set_members(state, List<TRest...>(), data, key, key_hash);
-            }
+            measured<List<Property<l, p>>, l>(
+                state,
+                " [set]",
+                [state, data]() { data->*p = TypeDef<decltype(data->*p)>::value(state, 3); }
+            );
         }
 
-        template <typename M, typename... Rest>
-        static int type_pairs_iter(
-            lua_State* state,
-            List<M, Rest...> /* members */,
-            T* data,
-            const std::uint32_t* key_hash
-        )
+        template <typename... M>
+        static void push_methods([[maybe_unused]] lua_State* state, List<M...> /* members */)
         {
-            if (key_hash == nullptr)
-            {
-                type_get_key(state, M());
-                type_get_member(state, M(), data);
-                return 2;
-            }
-            static constinit auto hash = hash_fnv1a(M());
-            if (*key_hash == hash)
-            {
-                return type_pairs_iter(state, List<Rest...>(), data, nullptr);
-            }
-            return type_pairs_iter(state, List<Rest...>(), data, key_hash);
+            (push_method(state, M()), ...);
         }
 
-        static void type_constructor(
-            lua_State* state,
-            List<> /* constructors */
-        )
+        template <xalt::literal l, auto p>
+        static void push_method(lua_State* state, Method<l, p> /* member */)
         {
-            luaL_error(state, "[%s] can't be constructed with the provided arguments", xalt::str_name_v<T>);
+            lua_pushcfunction(state, (&protect<&type_method<l, p>>));
+            lua_setfield(state, -2, xalt::literal_v<l>);
         }
 
-        static void type_get_members(
-            lua_State* state,
-            List<> /* props */,
-            T* /* data */,
-            const char* key,
-            std::uint32_t /* key_hash */
-        )
+        template <xalt::literal l, auto p>
+        static void push_method(lua_State* /* state */, Property<l, p> /* member */)
         {
-            luaL_error(state, "[%s] member [%s] is unknown", xalt::str_name_v<T>, key);
         }
 
-        static void type_set_members(
-            lua_State* state,
-            List<> /* props */,
-            T* /* data */,
-            const char* key,
-            std::uint32_t /* key_hash */
-        )
+        static std::string_view check_key(lua_State* state)
         {
-            luaL_error(state, "[%s] member [%s] is unknown", xalt::str_name_v<T>, key);
+            std::size_t size = 0;
+            const char* key = lua_tolstring(state, 2, &size);
+            if (key == nullptr)
+            {
+                throw_type_error(state, "string", lua_type(state, 2));
+            }
+            return {key, size};
         }
 
-        static int type_pairs_iter(
-            lua_State* /* state */,
-            List<> /* members */,
-            T* /* data */,
-            const std::uint32_t* /* key_hash */
-        )
+        [[noreturn]] static void throw_user_error(const std::string& message)
         {
-            return 0;
+            throw std::invalid_argument(
+                "Error: [" + std::string(xalt::str_name_v<T>) + "] " + message
+            );
         }
 
-        template <xalt::literal l, auto r>
-        static consteval auto hash_fnv1a(Property<l, r> /* info */) -> std::uint32_t
-        {
-            return hash_fnv1a(xalt::literal_v<l>);
-        }
+        using accessor = void (*)(lua_State*, T*);
 
-        template <xalt::literal l, auto r>
-        static consteval auto hash_fnv1a(Method<l, r> /* info */) -> std::uint32_t
+        static constexpr auto member_getters = []<typename... M>(List<M...>)
         {
-            return hash_fnv1a(xalt::literal_v<l>);
-        }
+            return std::array<accessor, sizeof...(M)>{
+                [](lua_State* state, T* data) { type_get_member(state, M(), data); }...
+            };
+        }(members());
 
-        static constexpr auto hash_fnv1a(
-            std::string_view literal,                 // NOLINT
-            std::uint32_t offset_basis = 0x811C9DC5u, // NOLINT
-            std::uint32_t prime = 0x01000193          // NOLINT
-        ) -> std::uint32_t
+        static constexpr auto member_setters = []<typename... M>(List<M...>)
         {
-            std::uint32_t hash = offset_basis;
-            for (auto i : literal)
-            {
-                hash ^= static_cast<std::uint8_t>(i);
-                hash *= prime;
-            }
-            return hash;
-        }
+            return std::array<accessor, sizeof...(M)>{
+                [](lua_State* state, T* data) { type_set_member(state, M(), data); }...
+            };
+        }(members());
     };
 }
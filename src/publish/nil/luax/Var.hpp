@@ -1,15 +1,18 @@
 #include "Ref.hpp"
+#include "Result.hpp"
 #include "TypeDef.hpp"
 
+#include <nil/xalt/str_name.hpp>
+
 #include <lua.h>
-#include <memory>
+#include <utility>
 
 namespace nil::luax
 {
     struct Var
     {
     public:
-        explicit Var(std::shared_ptr<Ref> init_ref)
+        explicit Var(Ref init_ref)
             : ref(std::move(init_ref))
         {
         }
@@ -22,7 +25,7 @@ namespace nil::luax
         ~Var() noexcept = default;
 
         template <typename T>
-            requires(is_value_type<T> || is_std_fn<T>)
+            requires(is_value_type<T> || is_std_fn<T> || is_lua_fn<T> || is_container_type<T>)
         // NOLINTNEXTLINE
         operator T() const
         {
@@ -30,7 +33,10 @@ namespace nil::luax
         }
 
         template <typename T>
-            requires(!is_value_type<std::remove_cvref_t<T>> && !is_std_fn<std::remove_cvref_t<T>>)
+            requires(
+                !is_value_type<std::remove_cvref_t<T>> && !is_std_fn<std::remove_cvref_t<T>>
+                && !is_lua_fn<std::remove_cvref_t<T>> && !is_container_type<std::remove_cvref_t<T>>
+            )
         // NOLINTNEXTLINE
         operator T&() const
         {
@@ -46,8 +52,27 @@ namespace nil::luax
             return TypeDef<T>::pull(ref);
         }
 
+        /**
+         * same as `as<T>()` but a type mismatch is returned instead of thrown.
+         */
+        template <typename T>
+            requires requires(lua_State* state) { TypeDef<T>::check(state, -1); }
+        Result<T> try_as() const
+        {
+            auto* state = ref.push();
+            if (!TypeDef<T>::check(state, -1))
+            {
+                auto error = Error::from_type(state, -1, xalt::str_name_v<std::remove_cvref_t<T>>);
+                lua_pop(state, 1);
+                return error;
+            }
+            Result<T> result = TypeDef<T>::value(state, -1);
+            lua_pop(state, 1);
+            return result;
+        }
+
     private:
-        std::shared_ptr<Ref> ref;
+        Ref ref;
 
         friend TypeDef<Var>;
     };
@@ -60,15 +85,15 @@ namespace nil::luax
         static Var value(lua_State* state, int index)
         {
             lua_pushvalue(state, index);
-            return Var(std::make_shared<Ref>(state));
+            return Var(Ref(state));
         }
 
         static void push(lua_State* /* state */, const Var& v)
         {
-            v.ref->push();
+            v.ref.push();
         }
 
-        static Var pull(const std::shared_ptr<Ref>& ref)
+        static Var pull(const Ref& ref)
         {
             return Var(ref);
         }
@@ -95,7 +120,7 @@ namespace nil::luax
             TypeDef<raw_type>::push(state, value);
         }
 
-        static decltype(auto) pull(const std::shared_ptr<Ref>& ref)
+        static decltype(auto) pull(const Ref& ref)
         {
             return TypeDef<raw_type>::pull(ref);
         }
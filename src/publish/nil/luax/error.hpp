@@ -1,16 +1,215 @@
 #pragma once
 
+#include "Context.hpp"
+
 extern "C"
 {
+#include <lauxlib.h>
 #include <lua.h>
 }
 
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace nil::luax
 {
-    inline void throw_error(lua_State* state)
+    /**
+     * thrown when a call is aborted because the budget of the state is exhausted
+     * (see `State::set_budget`).
+     */
+    class BudgetError final: public std::invalid_argument
+    {
+    public:
+        using std::invalid_argument::invalid_argument;
+    };
+
+    /**
+     * for errors returned by `lua_pcall`. the error object is popped from the stack.
+     */
+    inline std::string pop_error_message(lua_State* state)
+    {
+        const auto* message = lua_tostring(state, -1);
+        auto what = std::string(message == nullptr ? "(error object is not a string)" : message);
+        lua_pop(state, 1);
+        return what;
+    }
+
+    inline std::string type_error_message(lua_State* state, const char* expected, int actual)
+    {
+        return "expected [" + std::string(expected) + "], got [" + lua_typename(state, actual)
+            + "]";
+    }
+
+    [[noreturn]] inline void throw_call_error(lua_State* state)
+    {
+        if (Context::from(state).budget.raised_by_hook(lua_topointer(state, -1)))
+        {
+            throw BudgetError("Error: " + pop_error_message(state));
+        }
+        throw std::invalid_argument("Error: " + pop_error_message(state));
+    }
+
+    [[noreturn]] inline void throw_type_error(lua_State* state, const char* expected, int actual)
+    {
+        throw std::invalid_argument("Error: " + type_error_message(state, expected, actual));
+    }
+
+    /**
+     * returned by a function wrapped with `protect` to suspend the running thread
+     * until the `Async` it started completes (see `push_async`).
+     */
+    inline constexpr int yield_request = std::numeric_limits<int>::min();
+
+    /**
+     * continuation of a function suspended with `yield_request`.
+     * the thread is resumed with `true, results...` or `false, message` on top of the
+     * arguments of the call (`base` values).
+     */
+    inline int continue_async(lua_State* state, int /* status */, lua_KContext base)
+    {
+        if (lua_toboolean(state, int(base) + 1) == 0)
+        {
+            luaL_where(state, 1);
+            if (lua_type(state, int(base) + 2) == LUA_TSTRING)
+            {
+                lua_pushvalue(state, int(base) + 2);
+            }
+            else
+            {
+                // the result could not be moved to the thread
+                lua_pushliteral(state, "not enough memory");
+            }
+            lua_concat(state, 2);
+            return lua_error(state);
+        }
+        return lua_gettop(state) - int(base) - 1;
+    }
+
+    /**
+     * whether lua raises its errors as C++ exceptions (lua built as C++, see `LUAI_THROW`)
+     * rather than with longjmp. probed once per process on a throwaway state.
+     */
+    inline bool lua_throws_exceptions()
+    {
+        static const bool throws = []()
+        {
+            auto* state = luaL_newstate();
+            if (state == nullptr)
+            {
+                return false;
+            }
+            auto caught = false;
+            lua_pushcfunction(
+                state,
+                [](lua_State* s) -> int
+                {
+                    try
+                    {
+                        // nothing to destroy here in case it is a longjmp
+                        return lua_error(s);
+                    }
+                    catch (...)
+                    {
+                        *static_cast<bool*>(lua_touserdata(s, 1)) = true;
+                        throw;
+                    }
+                }
+            );
+            lua_pushlightuserdata(state, &caught);
+            lua_pcall(state, 1, 0, 0);
+            lua_close(state);
+            return caught;
+        }();
+        return throws;
+    }
+
+    /**
+     * copies `what` (without the `Error: ` prefix) to `message`, truncated if needed.
+     */
+    template <std::size_t N>
+    void copy_error_message(char (&message)[N], std::string_view what) // NOLINT
+    {
+        constexpr std::string_view prefix = "Error: ";
+        // the prefix is added back when the error reaches c++ again (`lua_pcall` sites)
+        if (what.starts_with(prefix))
+        {
+            what.remove_prefix(prefix.size());
+        }
+        const auto size = std::min(what.size(), N - 1);
+        std::memcpy(message, what.data(), size);
+        message[size] = '\0';
+    }
+
+    /**
+     * Boundary between lua and c++ used by every `lua_CFunction` created by luax.
+     *
+     * a c++ exception thrown by `fn` is converted to a lua error.
+     * `lua_error` (and `lua_yieldk`) is called outside of the try block, after every c++
+     * frame in between has been unwound, so the longjmp never skips a destructor.
+     * the message is copied to a fixed buffer so nothing is allocated on this path.
+     * exceptions of any type are caught (`unknown exception` when not an `std::exception`),
+     * a `BudgetError` stays a budget error for the enclosing protected call.
+     *
+     * the reverse direction is not covered: lua is a C library, so a lua error raised by an
+     * api call made inside `fn` (e.g. a memory error while pushing a value or creating a
+     * userdata) is a longjmp that skips the destructors of the c++ frames in between.
+     * `MemoryAccount` only refuses allocations during protected calls to keep these rare,
+     * `fn` should not hold resources across such calls (or build lua as C++).
+     * when lua is built as C++, its errors are exceptions of a type private to lua, so the
+     * exceptions that are not an `std::exception` are let through untouched for lua to handle.
+     *
+     * on success, this costs nothing more than the call to `fn`.
+     */
+    template <lua_CFunction fn>
+    int protect(lua_State* state)
     {
-        throw std::invalid_argument("Error: " + std::string(lua_tostring(state, -1)));
+        char message[256]; // NOLINT
+        bool yielding = false;
+        bool budget = false;
+        try
+        {
+            if (const auto count = fn(state); count != yield_request)
+            {
+                return count;
+            }
+            yielding = true;
+        }
+        catch (const BudgetError& e)
+        {
+            // still a budget error for the caller of the enclosing protected call
+            copy_error_message(message, e.what());
+            budget = true;
+        }
+        catch (const std::exception& e)
+        {
+            copy_error_message(message, e.what());
+        }
+        catch (...)
+        {
+            if (lua_throws_exceptions())
+            {
+                // possibly lua's own error, its message and status must reach lua untouched
+                throw;
+            }
+            // not an std::exception, it must not unwind through the lua vm either
+            copy_error_message(message, "unknown exception");
+        }
+        if (yielding)
+        {
+            return lua_yieldk(state, 0, lua_KContext(lua_gettop(state)), &continue_async);
+        }
+        luaL_where(state, 1);
+        lua_pushstring(state, message);
+        lua_concat(state, 2);
+        if (budget)
+        {
+            Context::from(state).budget.raising(lua_topointer(state, -1));
+        }
+        return lua_error(state);
     }
 }
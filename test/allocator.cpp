@@ -0,0 +1,97 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <cstdlib>
+
+namespace
+{
+    constexpr auto script = R"(
+        local parts = {}
+        for i = 1, 10000 do
+            parts[#parts + 1] = { index = i, name = "item" .. i }
+        end
+        local total = 0
+        for _, part in ipairs(parts) do
+            total = total + part.index + #part.name
+        end
+        value = total
+        text = string.rep("x", 2000) .. parts[10].name
+    )";
+
+    struct Counting
+    {
+        std::size_t allocations = 0;
+        std::size_t max_block = 1024 * 1024;
+
+        void* reallocate(void* ptr, std::size_t /* old_size */, std::size_t new_size)
+        {
+            if (new_size == 0)
+            {
+                std::free(ptr); // NOLINT
+                return nullptr;
+            }
+            if (new_size > max_block)
+            {
+                return nullptr;
+            }
+            ++allocations;
+            return std::realloc(ptr, new_size); // NOLINT
+        }
+    };
+}
+
+TEST(luax, allocator_pool)
+{
+    auto allocator = nil::luax::PoolAllocator();
+    const auto text = std::string(2000, 'x') + "item10";
+    for (auto i = 0; i < 3; ++i)
+    {
+        auto state = nil::luax::State(allocator);
+        state.open_libs();
+        state.run(script);
+        // sum of indices + sum of the name lengths
+        ASSERT_EQ(50005000 + 78894, state.get("value").as<int>());
+        ASSERT_EQ(text, state.get("text").as<std::string>());
+    }
+}
+
+TEST(luax, allocator_policy)
+{
+    auto allocator = Counting();
+    {
+        auto state = nil::luax::State(allocator);
+        state.open_libs();
+        const auto before = allocator.allocations;
+        state.run(script);
+        ASSERT_GT(allocator.allocations, before);
+
+        // a failing allocation is reported as a lua memory error
+        const auto result = state.try_run("local s = string.rep('x', 2 * 1024 * 1024)");
+        ASSERT_FALSE(result);
+        ASSERT_EQ(nil::luax::Error::Status::memory, result.error().status);
+
+        state.run(script);
+        ASSERT_GT(state.get("value").as<int>(), 0);
+    }
+}
+
+TEST(luax, allocator_warnings)
+{
+    constexpr auto script = "warn('hidden') warn('@on') warn('shown ', 'in parts') warn('@off')";
+    auto allocator = nil::luax::PoolAllocator();
+    auto custom = nil::luax::State(allocator);
+    custom.open_libs();
+    auto standard = nil::luax::State();
+    standard.open_libs();
+
+    // same output as the warning function of `luaL_newstate`
+    testing::internal::CaptureStderr();
+    standard.run(script);
+    const auto expected = testing::internal::GetCapturedStderr();
+    testing::internal::CaptureStderr();
+    custom.run(script);
+    ASSERT_EQ(expected, testing::internal::GetCapturedStderr());
+    ASSERT_EQ("Lua warning: shown in parts\n", expected);
+}
@@ -0,0 +1,126 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    struct Point
+    {
+        double x = 0.0;
+    };
+
+    // not default constructible
+    struct Labeled
+    {
+        explicit Labeled(int init_id)
+            : id(init_id)
+        {
+        }
+
+        int id;
+    };
+}
+
+template <>
+struct nil::luax::Meta<Point>
+{
+    using Members = nil::luax::List<nil::luax::Property<"x", &Point::x>>;
+};
+
+template <>
+struct nil::luax::Meta<Labeled>
+{
+    using Members = nil::luax::List<nil::luax::Property<"id", &Labeled::id>>;
+};
+
+TEST(luax, array_view_borrowed)
+{
+    auto samples = std::vector<float>{1.0f, 2.0f, 3.0f};
+
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set("samples", nil::luax::ArrayView<float>(samples));
+    state.run(R"(
+        total = 0
+        for i, v in ipairs(samples) do
+            total = total + v
+            samples[i] = v * 2
+        end
+        count = #samples
+        past_end = samples[4]
+        pairs_count = 0
+        for i, v in pairs(samples) do
+            pairs_count = pairs_count + i
+        end
+    )");
+    ASSERT_EQ(6.0, state.get("total").as<double>());
+    ASSERT_EQ(3, state.get("count").as<int>());
+    ASSERT_EQ(6, state.get("pairs_count").as<int>());
+    ASSERT_FALSE(state.get("past_end").as<std::optional<double>>().has_value());
+    ASSERT_THAT(samples, testing::ElementsAre(2.0f, 4.0f, 6.0f));
+
+    ASSERT_THROW(state.run("samples[4] = 1"), std::invalid_argument);
+    ASSERT_THROW(state.run("samples[0] = 1"), std::invalid_argument);
+    ASSERT_THROW(state.run("samples[1] = 'x'"), std::invalid_argument);
+    ASSERT_THROW(state.run("samples[1.5] = 1"), std::invalid_argument);
+    ASSERT_THROW(state.run("local v = samples.size"), std::invalid_argument);
+}
+
+TEST(luax, array_view_read_only)
+{
+    const auto samples = std::vector<int>{1, 2, 3};
+
+    auto state = nil::luax::State();
+    state.set("samples", nil::luax::ArrayView<const int>(samples));
+    state.run("second = samples[2]");
+    ASSERT_EQ(2, state.get("second").as<int>());
+    ASSERT_THROW(state.run("samples[1] = 1"), std::invalid_argument);
+}
+
+TEST(luax, array_view_owned)
+{
+    auto state = nil::luax::State();
+    state.set("samples", nil::luax::ArrayView<int>::owned({4, 5, 6}));
+    state.gc();
+    state.run(R"(
+        samples[1] = 7
+        first = samples[1]
+        last = samples[#samples]
+    )");
+    ASSERT_EQ(7, state.get("first").as<int>());
+    ASSERT_EQ(6, state.get("last").as<int>());
+}
+
+TEST(luax, array_view_owned_user_types)
+{
+    auto labels = std::vector<Labeled>();
+    labels.emplace_back(1);
+    labels.emplace_back(2);
+
+    auto state = nil::luax::State();
+    state.set("labels", nil::luax::ArrayView<Labeled>::owned(std::move(labels)));
+    state.run("labels[2].id = labels[1].id + labels[2].id");
+    ASSERT_EQ(3, state.get("labels").as<nil::luax::ArrayView<Labeled>&>()[1].id);
+}
+
+TEST(luax, array_view_argument_and_user_types)
+{
+    auto points = std::vector<Point>(2);
+
+    auto state = nil::luax::State();
+    state.set("points", nil::luax::ArrayView<Point>(points));
+    state.set("first", [](nil::luax::ArrayView<Point>& view) { return view[0].x; });
+    state.run(R"(
+        points[1].x = 1.5
+        points[2].x = 2.5
+        value = first(points)
+    )");
+    ASSERT_EQ(1.5, points[0].x);
+    ASSERT_EQ(2.5, points[1].x);
+    ASSERT_EQ(1.5, state.get("value").as<double>());
+}
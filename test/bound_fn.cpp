@@ -0,0 +1,80 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace
+{
+    int add(int l, int r)
+    {
+        return l + r;
+    }
+
+    std::tuple<int, std::string> split(int value)
+    {
+        return {value / 10, std::to_string(value % 10)};
+    }
+
+    void fail(int /* value */)
+    {
+        throw std::invalid_argument("Error: failed");
+    }
+
+    struct Accumulator
+    {
+        int total = 0;
+
+        int push(int value)
+        {
+            total += value;
+            return total;
+        }
+
+        int get() const
+        {
+            return total;
+        }
+    };
+}
+
+TEST(luax, bound_free_function)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set<&add>("add");
+    state.set<&split>("split");
+    state.set<&fail>("fail");
+    state.run(R"(
+        sum = add(1, 2)
+        tens, units = split(42)
+        ok, message = pcall(fail, 1)
+    )");
+    ASSERT_EQ(3, state.get("sum").as<int>());
+    ASSERT_EQ(4, state.get("tens").as<int>());
+    ASSERT_EQ("2", state.get("units").as<std::string>());
+    ASSERT_FALSE(state.get("ok").as<bool>());
+    ASSERT_THAT(state.get("message").as<std::string>(), testing::HasSubstr("failed"));
+
+    // no upvalue, no userdata
+    state.run("has_upvalue = debug.getupvalue(add, 1) ~= nil");
+    ASSERT_FALSE(state.get("has_upvalue").as<bool>());
+}
+
+TEST(luax, bound_member_function)
+{
+    auto state = nil::luax::State();
+    auto accumulator = Accumulator();
+    state.set<&Accumulator::push>("push", &accumulator);
+    state.set<&Accumulator::get>("get", &accumulator);
+    state.run("push(1) push(2) value = push(3)");
+    ASSERT_EQ(6, state.get("value").as<int>());
+    ASSERT_EQ(6, accumulator.total);
+
+    state.run("value = get()");
+    ASSERT_EQ(6, state.get("value").as<int>());
+    ASSERT_ANY_THROW(state.run("push('x')"));
+}
@@ -0,0 +1,134 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <chrono>
+#include <coroutine>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    std::coroutine_handle<> suspended; // NOLINT
+
+    // resumed by the test itself
+    struct Suspend
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) const
+        {
+            suspended = handle;
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    nil::luax::Async<> wait_for_test()
+    {
+        co_await Suspend();
+    }
+}
+
+TEST(luax, budget_instructions)
+{
+    auto state = nil::luax::State();
+    state.set_budget({.instructions = 100000});
+    ASSERT_THROW(state.run("while true do end"), nil::luax::BudgetError);
+
+    // sticky until the budget is set again
+    ASSERT_THROW(state.run("value = 1"), nil::luax::BudgetError);
+
+    state.set_budget({.instructions = 100000});
+    state.run("value = 0 for i = 1, 100 do value = value + i end");
+    ASSERT_EQ(5050, state.get("value").as<int>());
+}
+
+TEST(luax, budget_deadline)
+{
+    using namespace std::chrono_literals;
+    auto state = nil::luax::State();
+    state.set_budget({.duration = 20ms});
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = state.try_run("while true do end");
+    ASSERT_FALSE(result);
+    ASSERT_EQ(nil::luax::Error::Status::budget, result.error().status);
+    ASSERT_THAT(result.error().message(), testing::HasSubstr("budget exceeded"));
+    ASSERT_LT(std::chrono::steady_clock::now() - start, 5s);
+}
+
+TEST(luax, budget_pcall)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set_budget({.instructions = 100000});
+    // catching the error does not help, the next instruction fails again
+    ASSERT_THROW(
+        state.run("while true do pcall(function() while true do end end) end"),
+        nil::luax::BudgetError
+    );
+}
+
+TEST(luax, budget_function)
+{
+    auto state = nil::luax::State();
+    state.run("function spin(n) while n > 0 do n = n - 1 end return n end");
+    const auto spin = state.get("spin").as<nil::luax::Function<int(int)>>();
+
+    state.set_budget({.instructions = 10000});
+    ASSERT_EQ(0, spin(100));
+    ASSERT_THROW(spin(1000000), nil::luax::BudgetError);
+
+    state.clear_budget();
+    ASSERT_EQ(0, spin(1000000));
+    // other errors are not reported as budget errors
+    ASSERT_FALSE(state.try_run("error('x')").error().status == nil::luax::Error::Status::budget);
+}
+
+TEST(luax, budget_other_errors_while_exceeded)
+{
+    auto state = nil::luax::State();
+    state.run("function spin() while true do end end");
+    state.set(
+        "nested",
+        [spin = state.get("spin").as<nil::luax::Function<void()>>()]() { spin(); }
+    );
+
+    state.set_budget({.instructions = 10000});
+    ASSERT_THROW(state.run("nested()"), nil::luax::BudgetError);
+
+    // not raised by the budget, even if it is still exceeded
+    const auto syntax = state.try_run("value = ");
+    ASSERT_FALSE(syntax);
+    ASSERT_EQ(nil::luax::Error::Status::syntax, syntax.error().status);
+    ASSERT_EQ(nil::luax::Error::Status::budget, state.try_run("value = 1").error().status);
+}
+
+TEST(luax, budget_thread_spawned_before)
+{
+    auto state = nil::luax::State();
+    state.set("wait_for_test", &wait_for_test);
+    state.run("function session() wait_for_test() while true do end end");
+    const auto thread = state.spawn(state.get("session"));
+    ASSERT_EQ(nil::luax::ThreadStatus::waiting, thread.status());
+
+    // the thread is hooked when it is resumed
+    state.set_budget({.instructions = 100000});
+    std::exchange(suspended, {}).resume();
+    ASSERT_EQ(nil::luax::ThreadStatus::failed, thread.status());
+    try
+    {
+        thread.result();
+        FAIL();
+    }
+    catch (const std::invalid_argument& e)
+    {
+        ASSERT_THAT(e.what(), testing::HasSubstr("budget exceeded"));
+    }
+}
@@ -0,0 +1,89 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+TEST(luax, bytes_string_view_keeps_zeros)
+{
+    auto state = nil::luax::State();
+    state.set("length", [](std::string_view text) { return text.size(); });
+    state.set("copy", [](const std::string& text) { return text; });
+    state.set("literal", [](int) -> const char* { return "literal"; });
+    state.run(R"(
+        size = length('a\0b')
+        copied = copy('c\0d')
+        text = literal(1)
+    )");
+    ASSERT_EQ(3, state.get("size").as<int>());
+    ASSERT_EQ(std::string("c\0d", 3), state.get("copied").as<std::string>());
+    ASSERT_EQ("literal", state.get("text").as<std::string>());
+}
+
+TEST(luax, bytes_span_argument)
+{
+    auto state = nil::luax::State();
+    state.set("checksum", [](std::span<const std::byte> data)
+    {
+        int sum = 0;
+        for (const auto value : data)
+        {
+            sum += int(value);
+        }
+        return sum;
+    });
+    state.run(R"(
+        from_string = checksum('\1\2\0\3')
+    )");
+    ASSERT_EQ(6, state.get("from_string").as<int>());
+    ASSERT_THROW(state.run("checksum(1)"), std::invalid_argument);
+    ASSERT_THROW(state.run("checksum({})"), std::invalid_argument);
+}
+
+TEST(luax, bytes_userdata)
+{
+    const auto frame = std::string("\x02head\0payload", 13);
+
+    auto state = nil::luax::State();
+    state.set("frame", nil::luax::Bytes(std::as_bytes(std::span(frame))));
+    state.set("owned", nil::luax::Bytes::owned(std::vector<std::byte>(4, std::byte(7))));
+    state.set("checksum", [](std::span<const std::byte> data)
+    {
+        int sum = 0;
+        for (const auto value : data)
+        {
+            sum += int(value);
+        }
+        return sum;
+    });
+    state.run(R"(
+        size = #frame
+        kind = frame[1]
+        past_end = frame[100]
+        head = frame:sub(2, 5)
+        tail = frame:sub(-7)
+        empty = frame:sub(5, 2)
+        found = frame:find('payload')
+        missing = frame:find('nothing')
+        from_init = frame:find('a', 5)
+        sum = checksum(owned)
+    )");
+    ASSERT_EQ(13, state.get("size").as<int>());
+    ASSERT_EQ(2, state.get("kind").as<int>());
+    ASSERT_FALSE(state.get("past_end").as<std::optional<int>>().has_value());
+    ASSERT_EQ("head", state.get("head").as<std::string>());
+    ASSERT_EQ("payload", state.get("tail").as<std::string>());
+    ASSERT_EQ("", state.get("empty").as<std::string>());
+    ASSERT_EQ(7, state.get("found").as<int>());
+    ASSERT_FALSE(state.get("missing").as<std::optional<int>>().has_value());
+    ASSERT_EQ(8, state.get("from_init").as<int>());
+    ASSERT_EQ(28, state.get("sum").as<int>());
+    ASSERT_THROW(state.run("frame[1] = 0"), std::invalid_argument);
+}
@@ -0,0 +1,183 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+    std::filesystem::path make_directory(std::string_view name)
+    {
+        auto path = std::filesystem::temp_directory_path() / "luax-test" / name;
+        std::filesystem::remove_all(path);
+        return path;
+    }
+}
+
+TEST(luax, chunk_cache_run)
+{
+    const auto directory = make_directory("chunk_cache_run");
+    auto cache = nil::luax::ChunkCache(directory);
+    constexpr auto script = "value = 1 + 2";
+
+    for (auto i = 0; i < 2; ++i)
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(script);
+        ASSERT_EQ(3, state.get("value").as<int>());
+        ASSERT_TRUE(cache.read(nil::luax::ChunkCache::key(script, script)).has_value());
+    }
+
+    // the cached bytecode is what gets loaded
+    constexpr auto other = "value = 10";
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(other);
+    }
+    const auto bytecode = cache.read(nil::luax::ChunkCache::key(other, other));
+    ASSERT_TRUE(bytecode.has_value());
+    cache.write(nil::luax::ChunkCache::key(script, script), *bytecode);
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(script);
+        ASSERT_EQ(10, state.get("value").as<int>());
+    }
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    std::filesystem::remove_all(directory);
+}
+
+TEST(luax, chunk_cache_load)
+{
+    const auto directory = make_directory("chunk_cache_load");
+    std::filesystem::create_directories(directory);
+    const auto path = (directory / "script.lua").string();
+    std::ofstream(path) << "#!/usr/bin/env lua\nfunction fail() error('failed') end\nvalue = 2\n";
+
+    auto cache = nil::luax::ChunkCache(directory / "cache");
+    for (auto i = 0; i < 2; ++i)
+    {
+        auto state = nil::luax::State();
+        state.open_libs();
+        state.set_chunk_cache(&cache);
+        state.load(path);
+        ASSERT_EQ(2, state.get("value").as<int>());
+
+        // chunk name and line numbers are the same as without the cache
+        const auto result = state.try_run("fail()");
+        ASSERT_FALSE(result);
+        ASSERT_THAT(result.error().message(), testing::HasSubstr("script.lua:2: failed"));
+    }
+    ASSERT_LT(0, cache.size());
+    std::filesystem::remove_all(directory);
+}
+
+TEST(luax, chunk_cache_load_precompiled)
+{
+    const auto directory = make_directory("chunk_cache_load_precompiled");
+    std::filesystem::create_directories(directory);
+    const auto path = (directory / "script.luac").string();
+    {
+        auto state = nil::luax::State();
+        state.open_libs();
+        state.run("bytecode = string.dump(load('value = 5'))");
+        std::ofstream(path, std::ios::binary) << state.get("bytecode").as<std::string>();
+    }
+
+    // loaded as is, like `luaL_loadfile` does
+    auto cache = nil::luax::ChunkCache(directory / "cache");
+    auto state = nil::luax::State();
+    state.set_chunk_cache(&cache);
+    state.load(path);
+    ASSERT_EQ(5, state.get("value").as<int>());
+    ASSERT_EQ(0, cache.size());
+    std::filesystem::remove_all(directory);
+}
+
+TEST(luax, chunk_cache_invalid_entry)
+{
+    const auto directory = make_directory("chunk_cache_invalid_entry");
+    auto cache = nil::luax::ChunkCache(directory);
+    constexpr auto script = "value = 3";
+    const auto key = nil::luax::ChunkCache::key(script, script);
+
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(script);
+    }
+    ASSERT_EQ(1, std::distance(std::filesystem::directory_iterator(directory), {}));
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        std::ofstream(entry.path(), std::ios::binary) << "corrupted";
+    }
+    ASSERT_FALSE(cache.read(key).has_value());
+
+    // not bytecode, lua rejects it and the source is used
+    cache.write(key, "not bytecode");
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(script);
+        ASSERT_EQ(3, state.get("value").as<int>());
+    }
+    ASSERT_NE("not bytecode", cache.read(key));
+    std::filesystem::remove_all(directory);
+}
+
+TEST(luax, chunk_cache_max_size)
+{
+    const auto directory = make_directory("chunk_cache_max_size");
+    constexpr auto max_size = 1024;
+    auto cache = nil::luax::ChunkCache(directory, max_size);
+
+    auto state = nil::luax::State();
+    state.set_chunk_cache(&cache);
+    for (auto i = 0; i < 100; ++i)
+    {
+        state.run("value = " + std::to_string(i));
+        ASSERT_GE(max_size, cache.size());
+    }
+    ASSERT_LT(0, cache.size());
+    std::filesystem::remove_all(directory);
+}
+
+TEST(luax, chunk_cache_collision_and_checksum)
+{
+    const auto directory = make_directory("chunk_cache_collision_and_checksum");
+    auto cache = nil::luax::ChunkCache(directory);
+    constexpr auto script = "value = 4";
+
+    {
+        auto state = nil::luax::State();
+        state.set_chunk_cache(&cache);
+        state.run(script);
+    }
+    const auto key = nil::luax::ChunkCache::key(script, script);
+    const auto bytecode = cache.read(key);
+    ASSERT_TRUE(bytecode.has_value());
+
+    // same hash, other chunk: the entry is not used for it
+    auto collision = key;
+    collision.source = "value = 5";
+    ASSERT_FALSE(cache.read(collision).has_value());
+
+    // a flipped byte in the bytecode fails the checksum
+    cache.write(key, *bytecode);
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        auto file = std::fstream(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\x7f');
+    }
+    ASSERT_FALSE(cache.read(key).has_value());
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,142 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <array>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+TEST(luax, container_vector)
+{
+    auto state = nil::luax::State();
+    state.set("scale", [](const std::vector<double>& values, double factor)
+    {
+        auto result = std::vector<double>();
+        for (const auto value : values)
+        {
+            result.push_back(value * factor);
+        }
+        return result;
+    });
+    state.set("nested", std::vector<std::vector<int>>{{1, 2}, {3}});
+    state.run(R"(
+        scaled = scale({1, 2, 3}, 2)
+        count = #scaled
+        inner = nested[1][2] + nested[2][1]
+    )");
+    ASSERT_EQ(3, state.get("count").as<int>());
+    ASSERT_EQ(5, state.get("inner").as<int>());
+    ASSERT_THAT(state.get("scaled").as<std::vector<double>>(), testing::ElementsAre(2.0, 4.0, 6.0));
+    ASSERT_THROW(state.run("scale({1, 'x'}, 2)"), std::invalid_argument);
+    ASSERT_THROW(state.run("scale(1, 2)"), std::invalid_argument);
+}
+
+TEST(luax, container_array_and_pair)
+{
+    auto state = nil::luax::State();
+    state.set("sum", [](std::array<int, 3> values) { return values[0] + values[1] + values[2]; });
+    state.set("swap", [](const std::pair<int, std::string>& value)
+    { return std::pair<std::string, int>(value.second, value.first); });
+    state.run(R"(
+        total = sum({1, 2, 3})
+        swapped = swap({1, 'one'})
+    )");
+    ASSERT_EQ(6, state.get("total").as<int>());
+    const auto swapped = state.get("swapped").as<std::pair<std::string, int>>();
+    ASSERT_EQ("one", swapped.first);
+    ASSERT_EQ(1, swapped.second);
+    ASSERT_THROW(state.run("sum({1, 2})"), std::invalid_argument);
+}
+
+TEST(luax, container_map)
+{
+    auto state = nil::luax::State();
+    state.set("invert", [](const std::map<std::string, int>& value)
+    {
+        auto result = std::unordered_map<int, std::string>();
+        for (const auto& [k, v] : value)
+        {
+            result.emplace(v, k);
+        }
+        return result;
+    });
+    state.run(R"(
+        inverted = invert({ one = 1, two = 2 })
+        one = inverted[1]
+        numeric = invert({ [1] = 10 })
+    )");
+    ASSERT_EQ("one", state.get("one").as<std::string>());
+    const auto inverted = state.get("inverted").as<std::map<int, std::string>>();
+    ASSERT_EQ(2, inverted.size());
+    ASSERT_EQ("two", inverted.at(2));
+    // integer keys are converted with lua_isstring, like arguments
+    const auto numeric = state.get("numeric").as<std::map<int, std::string>>();
+    ASSERT_EQ("1", numeric.at(10));
+    ASSERT_THROW(state.run("invert({ one = 'x' })"), std::invalid_argument);
+}
+
+TEST(luax, container_map_of_var)
+{
+    auto state = nil::luax::State();
+    state.run("config = { name = 'luax', size = 3 }");
+    const auto config = state.get("config").as<std::unordered_map<std::string, nil::luax::Var>>();
+    ASSERT_EQ(2, config.size());
+    ASSERT_EQ("luax", config.at("name").as<std::string>());
+    ASSERT_EQ(3, config.at("size").as<int>());
+}
+
+TEST(luax, container_optional_and_variant)
+{
+    using value_type = std::variant<int, std::string, std::vector<int>>;
+
+    auto state = nil::luax::State();
+    state.set("describe", [](const value_type& value) -> std::optional<std::string>
+    {
+        if (const auto* text = std::get_if<std::string>(&value))
+        {
+            return *text;
+        }
+        if (const auto* values = std::get_if<std::vector<int>>(&value))
+        {
+            return std::to_string(values->size());
+        }
+        return std::nullopt;
+    });
+    state.set("either", [](std::optional<int> value) { return value.value_or(-1); });
+    state.run(R"(
+        text = describe('text')
+        size = describe({1, 2})
+        none = describe(1)
+        missing = either(nil)
+        present = either(4)
+    )");
+    ASSERT_EQ("text", state.get("text").as<std::string>());
+    ASSERT_EQ("2", state.get("size").as<std::string>());
+    ASSERT_FALSE(state.get("none").as<std::optional<std::string>>().has_value());
+    ASSERT_EQ(-1, state.get("missing").as<int>());
+    ASSERT_EQ(4, state.get("present").as<int>());
+    ASSERT_THROW(state.run("describe(true)"), std::invalid_argument);
+
+    ASSERT_FALSE(state.get("text").try_as<std::vector<int>>().has_value());
+    ASSERT_TRUE(state.get("size").try_as<std::string>().has_value());
+}
+
+TEST(luax, container_string_elements_are_copied)
+{
+    // numbers are converted to strings on a copied stack slot, the result is owned
+    auto state = nil::luax::State();
+    state.run("values = { 1, 'two', 3.5 } named = { [10] = 20 }");
+    ASSERT_THAT(
+        state.get("values").as<std::vector<std::string>>(),
+        testing::ElementsAre("1", "two", "3.5")
+    );
+    const auto named = state.get("named").as<std::map<std::string, std::string>>();
+    ASSERT_EQ("20", named.at("10"));
+}
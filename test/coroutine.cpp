@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <coroutine>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    /**
+     * minimal event loop, every awaited event completes on the next `run`.
+     */
+    struct Loop
+    {
+        std::deque<std::coroutine_handle<>> ready;
+
+        auto next()
+        {
+            struct Awaiter
+            {
+                Loop& loop;
+
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<> handle) const
+                {
+                    loop.ready.push_back(handle);
+                }
+
+                void await_resume() const noexcept
+                {
+                }
+            };
+
+            return Awaiter{*this};
+        }
+
+        void run()
+        {
+            while (!ready.empty())
+            {
+                auto handle = ready.front();
+                ready.pop_front();
+                handle.resume();
+            }
+        }
+    };
+
+    Loop loop; // NOLINT
+
+    nil::luax::Async<int> fetch(int id)
+    {
+        co_await loop.next();
+        co_return id * 10;
+    }
+
+    nil::luax::Async<int> fetch_twice(int id)
+    {
+        const auto first = co_await fetch(id);
+        co_return first + co_await fetch(id);
+    }
+
+    nil::luax::Async<int> immediate(int id)
+    {
+        co_return id;
+    }
+
+    nil::luax::Async<> fail()
+    {
+        co_await loop.next();
+        throw std::runtime_error("Error: fetch failed");
+    }
+
+    std::string describe(const std::string& text)
+    {
+        return "text " + text;
+    }
+
+    int alive = 0; // NOLINT
+
+    struct Alive
+    {
+        Alive()
+        {
+            ++alive;
+        }
+
+        ~Alive()
+        {
+            --alive;
+        }
+
+        Alive(const Alive&) = delete;
+        Alive(Alive&&) = delete;
+        Alive& operator=(const Alive&) = delete;
+        Alive& operator=(Alive&&) = delete;
+    };
+
+    // waits on an operation that never completes
+    nil::luax::Async<int> forever()
+    {
+        const auto guard = Alive();
+        co_await std::suspend_always();
+        co_return 0;
+    }
+
+    nil::luax::Async<int> sum_twice(const nil::luax::Coroutine<int>& thread)
+    {
+        const auto first = co_await thread;
+        co_return first + co_await thread;
+    }
+
+    nil::luax::Async<int> gather(nil::luax::State& state)
+    {
+        const auto first = state.spawn<int>(state.get("session"), 1);
+        const auto second = state.spawn<int>(state.get("session"), 2);
+        co_return co_await first + co_await second;
+    }
+}
+
+TEST(luax, coroutine_interleaved_threads)
+{
+    auto state = nil::luax::State();
+    state.set("fetch", &fetch);
+    state.set("fetch_twice", &fetch_twice);
+    state.run(R"(
+        order = ''
+        function session(id)
+            order = order .. 'a' .. id
+            local a = fetch(id)
+            order = order .. 'b' .. id
+            return a + fetch_twice(id)
+        end
+    )");
+
+    const auto first = state.spawn<int>(state.get("session"), 1);
+    const auto second = state.spawn<int>(state.get("session"), 2);
+    ASSERT_FALSE(first.done());
+    ASSERT_EQ(nil::luax::ThreadStatus::waiting, second.status());
+    ASSERT_THROW((void)first.result(), std::invalid_argument);
+    ASSERT_EQ("a1a2", state.get("order").as<std::string>());
+
+    loop.run();
+    ASSERT_TRUE(first.done());
+    ASSERT_EQ(30, first.result());
+    ASSERT_EQ(60, second.result());
+    ASSERT_EQ("a1a2b1b2", state.get("order").as<std::string>());
+}
+
+TEST(luax, coroutine_completed_without_waiting)
+{
+    auto state = nil::luax::State();
+    state.set("immediate", &immediate);
+    state.run("function session(id) return immediate(id) + 1 end");
+
+    const auto thread = state.spawn<int>(state.get("session"), 4);
+    ASSERT_TRUE(thread.done());
+    ASSERT_EQ(5, thread.result());
+}
+
+TEST(luax, coroutine_errors)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set("fetch", &fetch);
+    state.set("fail", &fail);
+    state.run(R"(
+        function guarded()
+            local ok, message = pcall(fail)
+            return message
+        end
+        function unguarded()
+            fail()
+        end
+        function yielding()
+            coroutine.yield(1)
+        end
+    )");
+
+    const auto guarded = state.spawn<std::string>(state.get("guarded"));
+    const auto unguarded = state.spawn(state.get("unguarded"));
+    loop.run();
+    ASSERT_NE(guarded.result().find("fetch failed"), std::string::npos);
+    ASSERT_EQ(nil::luax::ThreadStatus::failed, unguarded.status());
+    ASSERT_THROW(unguarded.result(), std::invalid_argument);
+
+    const auto yielding = state.spawn(state.get("yielding"));
+    ASSERT_EQ(nil::luax::ThreadStatus::failed, yielding.status());
+
+    // the main thread can not wait
+    ASSERT_THROW(state.run("fetch(1)"), std::invalid_argument);
+    ASSERT_TRUE(loop.ready.empty());
+}
+
+TEST(luax, coroutine_awaited_from_cpp)
+{
+    auto state = nil::luax::State();
+    state.set("fetch", &fetch);
+    state.run("function session(id) return fetch(id) + 1 end");
+
+    auto task = gather(state);
+    task.start();
+    ASSERT_FALSE(task.done());
+    loop.run();
+    ASSERT_TRUE(task.done());
+    ASSERT_EQ(32, task.result());
+}
+
+TEST(luax, coroutine_in_overload_set)
+{
+    auto state = nil::luax::State();
+    state.set<&fetch, &describe>("lookup");
+    state.run("function session(id) return lookup(id) .. ' ' .. lookup('x') end");
+
+    const auto thread = state.spawn<std::string>(state.get("session"), 3);
+    ASSERT_EQ(nil::luax::ThreadStatus::waiting, thread.status());
+    loop.run();
+    ASSERT_EQ("30 text x", thread.result());
+}
+
+TEST(luax, coroutine_awaited_twice)
+{
+    auto state = nil::luax::State();
+    state.set("fetch", &fetch);
+    state.run("function session(id) return fetch(id) end");
+
+    const auto thread = state.spawn<int>(state.get("session"), 2);
+    auto first = sum_twice(thread);
+    auto second = sum_twice(thread);
+    first.start();
+    second.start();
+    loop.run();
+    ASSERT_TRUE(first.done());
+    ASSERT_TRUE(second.done());
+    ASSERT_EQ(40, first.result());
+    ASSERT_EQ(40, second.result());
+}
+
+TEST(luax, coroutine_pending_frames_destroyed_with_state)
+{
+    {
+        auto state = nil::luax::State();
+        state.set("forever", &forever);
+        state.run("function session() return forever() end");
+        const auto thread = state.spawn<int>(state.get("session"));
+        ASSERT_EQ(nil::luax::ThreadStatus::waiting, thread.status());
+        ASSERT_EQ(1, alive);
+    }
+    ASSERT_EQ(0, alive);
+}
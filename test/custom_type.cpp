@@ -24,3 +24,41 @@ TEST(luax, custom_type)
     state.set("custom_value", value);
     ASSERT_EQ(&value, &state.get("custom_value").as<CustomType&>());
 }
+
+struct OtherCustomType
+{
+};
+
+template <>
+struct nil::luax::Meta<OtherCustomType>
+{
+};
+
+TEST(luax, custom_type_identity)
+{
+    auto state = nil::luax::State();
+
+    state.add_type<CustomType>();
+    state.add_type<OtherCustomType>();
+
+    CustomType value;
+    OtherCustomType other_value;
+    state.set("custom_value", value);
+    state.set("other_custom_value", other_value);
+    state.set("accept", [](CustomType& /* value */) {});
+
+    ASSERT_EQ(&value, &state.get("custom_value").as<CustomType&>());
+    ASSERT_EQ(&other_value, &state.get("other_custom_value").as<OtherCustomType&>());
+    ASSERT_THROW(state.get("custom_value").as<OtherCustomType&>(), std::invalid_argument);
+    ASSERT_THROW(state.get("other_custom_value").as<CustomType&>(), std::invalid_argument);
+    ASSERT_NO_THROW(state.run("accept(custom_value)"));
+}
+
+TEST(luax, custom_type_without_add_type)
+{
+    auto state = nil::luax::State();
+
+    CustomType value;
+    state.set("custom_value", value);
+    ASSERT_EQ(&value, &state.get("custom_value").as<CustomType&>());
+}
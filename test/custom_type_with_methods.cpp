@@ -52,3 +52,76 @@ TEST(luax, custom_type_with_methods)
         call(object);
     }
 }
+
+TEST(luax, custom_type_with_methods_unknown_member)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+
+    testing::StrictMock<testing::MockFunction<void(CustomTypeWithMethod*)>> mock;
+    auto object = CustomTypeWithMethod{&mock};
+    state.set("object", object);
+    state.run(R"(
+        ok_unknown, message_unknown = pcall(function() return object.unknown end)
+        ok_key, message_key = pcall(function() return object[{}] end)
+    )");
+
+    ASSERT_FALSE(state.get("ok_unknown").as<bool>());
+    ASSERT_THAT(
+        state.get("message_unknown").as<std::string>(),
+        testing::EndsWith("member [unknown] is unknown")
+    );
+    ASSERT_FALSE(state.get("ok_key").as<bool>());
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+struct CustomTypeWithMethodsAndProperties
+{
+    int value;
+
+    int add(int v)
+    {
+        value += v;
+        return value;
+    }
+};
+
+template <>
+struct nil::luax::Meta<CustomTypeWithMethodsAndProperties>
+{
+    using Members = nil::luax::List<
+        nil::luax::Property<"value", &CustomTypeWithMethodsAndProperties::value>,
+        nil::luax::Method<"add", &CustomTypeWithMethodsAndProperties::add>>;
+};
+
+TEST(luax, custom_type_with_methods_and_properties)
+{
+    auto state = nil::luax::State();
+
+    state.add_type<CustomTypeWithMethodsAndProperties>();
+    state.run(R"(
+        function call(custom_value)
+            return custom_value:add(2) + custom_value.value
+        end
+        function replace(custom_value)
+            custom_value.add = 1
+        end
+        function call_with_invalid_self(custom_value)
+            return custom_value.add(1, 2)
+        end
+    )");
+
+    CustomTypeWithMethodsAndProperties object = {1};
+
+    ASSERT_EQ(6, state.get("call").as<int(CustomTypeWithMethodsAndProperties&)>()(object));
+    ASSERT_EQ(3, object.value);
+
+    ASSERT_THROW(
+        state.get("replace").as<void(CustomTypeWithMethodsAndProperties&)>()(object),
+        std::invalid_argument
+    );
+    ASSERT_THROW(
+        state.get("call_with_invalid_self").as<int(CustomTypeWithMethodsAndProperties&)>()(object),
+        std::invalid_argument
+    );
+}
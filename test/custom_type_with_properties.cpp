@@ -114,3 +114,38 @@ TEST(luax, custom_type_with_properties_as_fn_arg)
         ASSERT_EQ("hello world", get_s(object1));
     }
 }
+
+TEST(luax, custom_type_with_properties_pairs)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+
+    state.add_type<CustomTypeWithProperties>("CustomTypeWithProperties");
+    state.run(R"(
+        local custom_value = CustomTypeWithProperties(true, 1.1, 2, "hello world")
+        keys = ""
+        for k, v in pairs(custom_value) do
+            keys = keys .. k .. "=" .. tostring(v) .. ";"
+        end
+    )");
+
+    ASSERT_EQ("b=true;d=1.1;i=2;s=hello world;", state.get("keys").as<std::string>());
+}
+
+TEST(luax, custom_type_with_properties_unknown_member)
+{
+    using table = nil::luax::MemberTable<nil::luax::Meta<CustomTypeWithProperties>::Members>;
+    static_assert(table::find("b") == 0);
+    static_assert(table::find("s") == 3);
+    static_assert(table::find("x") == table::size);
+
+    auto state = nil::luax::State();
+
+    state.add_type<CustomTypeWithProperties>("CustomTypeWithProperties");
+    state.run(R"(custom_value = CustomTypeWithProperties(true, 1.1, 2, "hello world"))");
+
+    // keys are compared in full, including embedded nul characters
+    ASSERT_THROW(state.run("return custom_value.bb"), std::invalid_argument);
+    ASSERT_THROW(state.run("return custom_value['b\\0']"), std::invalid_argument);
+    ASSERT_THROW(state.run("custom_value.x = 1"), std::invalid_argument);
+}
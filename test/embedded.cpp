@@ -0,0 +1,47 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <embedded_modules.hpp>
+
+TEST(luax, embedded_require)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.add_embedded(embedded_modules);
+    state.run(R"(
+        local greet = require("greet")
+        value = greet.hello("world")
+        same = greet == require("greet")
+    )");
+    ASSERT_EQ("hello world 42", state.get("value").as<std::string>());
+    ASSERT_TRUE(state.get("same").as<bool>());
+}
+
+TEST(luax, embedded_chunkname)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.add_embedded(embedded_modules);
+    // error positions refer to the module name, not to a build path
+    const auto result = state.try_run(R"(require("greet").fail())");
+    ASSERT_FALSE(result);
+    ASSERT_THAT(result.error().message(), testing::HasSubstr("greet:8: failed"));
+}
+
+TEST(luax, embedded_not_found)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.add_embedded(embedded_modules);
+    const auto result = state.try_run(R"(require("missing"))");
+    ASSERT_FALSE(result);
+    ASSERT_THAT(result.error().message(), testing::HasSubstr("no embedded module 'missing'"));
+}
+
+TEST(luax, embedded_without_package)
+{
+    auto state = nil::luax::State();
+    ASSERT_THROW(state.add_embedded(embedded_modules), std::invalid_argument);
+}
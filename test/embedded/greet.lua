@@ -0,0 +1,10 @@
+local math = require("util.math")
+
+return {
+    hello = function(name)
+        return "hello " .. name .. " " .. math.twice(21)
+    end,
+    fail = function()
+        error("failed")
+    end
+}
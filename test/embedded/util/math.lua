@@ -0,0 +1,5 @@
+return {
+    twice = function(value)
+        return value * 2
+    end
+}
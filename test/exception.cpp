@@ -0,0 +1,139 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <stdexcept>
+
+struct Guarded
+{
+    int value = 0;
+
+    int fail()
+    {
+        throw std::runtime_error("method failed");
+    }
+};
+
+template <>
+struct nil::luax::Meta<Guarded>
+{
+    using Members = nil::luax::List<
+        nil::luax::Property<"value", &Guarded::value>,
+        nil::luax::Method<"fail", &Guarded::fail>>;
+};
+
+struct Destroyed
+{
+    int* count;
+
+    ~Destroyed() noexcept
+    {
+        ++*count;
+    }
+};
+
+TEST(luax, exception_to_lua_error)
+{
+    auto destroyed = 0;
+
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set(
+        "fail",
+        [&destroyed]()
+        {
+            const auto guard = Destroyed{&destroyed};
+            throw std::runtime_error("closure failed");
+        }
+    );
+    state.set("accept", [](int v) { return v; });
+    auto object = Guarded();
+    state.set("object", object);
+
+    // c++ exceptions are catchable from lua
+    state.run(R"(
+        ok_fail, message_fail = pcall(fail)
+        ok_accept, message_accept = pcall(accept, "text")
+        ok_method, message_method = pcall(function() return object:fail() end)
+        ok_unknown, message_unknown = pcall(function() return object.unknown end)
+        ok_key, message_key = pcall(function() return object[{}] end)
+    )");
+
+    ASSERT_EQ(1, destroyed);
+    ASSERT_FALSE(state.get("ok_fail").as<bool>());
+    ASSERT_THAT(state.get("message_fail").as<std::string>(), testing::EndsWith("closure failed"));
+    ASSERT_FALSE(state.get("ok_accept").as<bool>());
+    ASSERT_THAT(
+        state.get("message_accept").as<std::string>(),
+        testing::EndsWith("expected [int], got [string]")
+    );
+    ASSERT_FALSE(state.get("ok_method").as<bool>());
+    ASSERT_THAT(state.get("message_method").as<std::string>(), testing::EndsWith("method failed"));
+    ASSERT_FALSE(state.get("ok_unknown").as<bool>());
+    ASSERT_THAT(
+        state.get("message_unknown").as<std::string>(),
+        testing::EndsWith("member [unknown] is unknown")
+    );
+    ASSERT_FALSE(state.get("ok_key").as<bool>());
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, exception_back_to_cpp)
+{
+    auto state = nil::luax::State();
+    state.set("fail", []() { throw std::runtime_error("closure failed"); });
+
+    try
+    {
+        state.run("fail()");
+        FAIL();
+    }
+    catch (const std::invalid_argument& e)
+    {
+        ASSERT_THAT(e.what(), testing::StartsWith("Error: [string \"fail()\"]:1: closure failed"));
+    }
+
+    auto fail = state.get("fail").as<nil::luax::Function<void()>>();
+    ASSERT_THROW(fail(), std::invalid_argument);
+    ASSERT_FALSE(fail.try_call());
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, exception_of_any_type)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set("boom", []() { throw 42; });
+    state.run("ok, message = pcall(boom)");
+    ASSERT_FALSE(state.get("ok").as<bool>());
+    if (!nil::luax::lua_throws_exceptions())
+    {
+        // otherwise lua handles it with its own errors
+        ASSERT_THAT(
+            state.get("message").as<std::string>(),
+            testing::EndsWith("unknown exception")
+        );
+    }
+    ASSERT_THROW(state.run("boom()"), std::invalid_argument);
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, exception_raised_by_lua_in_binding)
+{
+    auto state = nil::luax::State();
+    // pushing the result fails, lua raises the error from within the binding
+    state.set(
+        "grow",
+        []()
+        {
+            static const auto text = std::string(1024 * 1024, 'x');
+            return text.c_str();
+        }
+    );
+    state.set_memory_limit(state.memory().current + 64 * 1024);
+    const auto result = state.try_run("grow()");
+    ASSERT_FALSE(result);
+    ASSERT_EQ(nil::luax::Error::Status::memory, result.error().status);
+    ASSERT_EQ(0, state.stack_depth());
+}
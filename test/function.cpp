@@ -0,0 +1,81 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+TEST(luax, function_call)
+{
+    auto state = nil::luax::State();
+    state.run(R"(
+        function add(a, b) return a + b end
+        function split(a) return a, a * 2 end
+        function concat(a, b) return a .. b end
+        called = 0
+        function touch() called = called + 1 end
+    )");
+
+    auto add = state.get("add").as<nil::luax::Function<int(int, int)>>();
+    static_assert(std::is_same_v<decltype(add), nil::luax::Function<int(int, int)>>);
+    ASSERT_EQ(3, add(1, 2));
+
+    nil::luax::Function<std::tuple<int, int>(int)> split = state.get("split");
+    ASSERT_EQ(std::make_tuple(2, 4), split(2));
+
+    using Concat = nil::luax::Function<std::string(const std::string&, int)>;
+    auto concat = state.get("concat").as<Concat>();
+    ASSERT_EQ("hello1", concat("hello", 1));
+
+    auto touch = state.get("touch").as<nil::luax::Function<void()>>();
+    touch();
+    touch();
+    ASSERT_EQ(2, state.get("called").as<int>());
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, function_pinned)
+{
+    auto state = nil::luax::State();
+    state.run("function add(a, b) return a + b end");
+
+    auto add = state.get("add").as<nil::luax::Function<int(int, int)>>();
+    {
+        auto pinned = add.pin();
+        ASSERT_EQ(1, state.stack_depth());
+        for (auto i = 0; i < 10; ++i)
+        {
+            ASSERT_EQ(i + 1, pinned(i, 1));
+        }
+        ASSERT_EQ(1, state.stack_depth());
+    }
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, function_as_argument)
+{
+    auto state = nil::luax::State();
+    state.set("apply", [](const nil::luax::Function<int(int)>& fn, int v) { return fn(v); });
+    state.set("forward", [](nil::luax::Function<int(int)> fn) { return fn; });
+    state.run(R"(
+        result = apply(function(v) return v * 3 end, 2)
+        forwarded = forward(function(v) return v + 1 end)(1)
+    )");
+
+    ASSERT_EQ(6, state.get("result").as<int>());
+    ASSERT_EQ(2, state.get("forwarded").as<int>());
+}
+
+TEST(luax, function_errors)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.run(R"(
+        value = 1
+        function fail() error("failed") end
+    )");
+
+    ASSERT_THROW(state.get("value").as<nil::luax::Function<void()>>(), std::invalid_argument);
+
+    auto fail = state.get("fail").as<nil::luax::Function<void()>>();
+    ASSERT_THROW(fail(), std::invalid_argument);
+    ASSERT_EQ(0, state.stack_depth());
+}
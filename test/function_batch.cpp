@@ -0,0 +1,85 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <array>
+#include <vector>
+
+TEST(luax, function_call_each)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.run(R"(
+        function score(a, b)
+            if a < 0 then error("negative") end
+            if a == 0 then return "zero" end
+            return a * b
+        end
+        function split(a) return a, -a end
+        function pair(a)
+            if a < 0 then return a, "negative" end
+            return a, a * 2
+        end
+        total = 0
+        function accumulate(a) total = total + a end
+    )");
+
+    {
+        auto score = state.get("score").as<nil::luax::Function<int(int, int)>>();
+        const auto a = std::array{1, -1, 0, 4};
+        const auto b = std::array{2, 2, 2, 3};
+        auto out = std::array{0, 0, 0, 0};
+
+        const auto errors = score.call_each(out, a, b);
+
+        ASSERT_THAT(out, testing::ElementsAre(2, 0, 0, 12));
+        ASSERT_EQ(2, errors.size());
+        ASSERT_EQ(1, errors[0].index);
+        ASSERT_THAT(errors[0].message, testing::HasSubstr("negative"));
+        ASSERT_EQ(2, errors[1].index);
+        ASSERT_THAT(errors[1].message, testing::HasSubstr("got [string]"));
+    }
+    {
+        auto split = state.get("split").as<nil::luax::Function<std::tuple<int, int>(int)>>();
+        const auto a = std::vector{1, 2};
+        auto out = std::vector<std::tuple<int, int>>(2);
+
+        ASSERT_TRUE(split.call_each(out, a).empty());
+        ASSERT_EQ(std::make_tuple(2, -2), out[1]);
+    }
+    {
+        // the second result does not match, the first one is not written either
+        auto pair = state.get("pair").as<nil::luax::Function<std::tuple<int, int>(int)>>();
+        const auto a = std::vector{1, -1};
+        auto out = std::vector<std::tuple<int, int>>(2, std::make_tuple(7, 7));
+
+        const auto errors = pair.call_each(out, a);
+        ASSERT_EQ(1, errors.size());
+        ASSERT_EQ(1, errors[0].index);
+        ASSERT_EQ(std::make_tuple(1, 2), out[0]);
+        ASSERT_EQ(std::make_tuple(7, 7), out[1]);
+    }
+    {
+        auto accumulate = state.get("accumulate").as<nil::luax::Function<void(int)>>();
+        const auto a = std::vector{1, 2, 3};
+
+        ASSERT_TRUE(accumulate.call_each(a).empty());
+        ASSERT_EQ(6, state.get("total").as<int>());
+    }
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, function_call_each_size_mismatch)
+{
+    auto state = nil::luax::State();
+    state.run("function add(a, b) return a + b end");
+
+    auto add = state.get("add").as<nil::luax::Function<int(int, int)>>();
+    const auto a = std::array{1, 2};
+    const auto b = std::array{1};
+    auto out = std::array{0, 0};
+
+    ASSERT_THROW(add.call_each(out, a, b), std::invalid_argument);
+    ASSERT_EQ(0, state.stack_depth());
+}
@@ -0,0 +1,96 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+struct Tracked
+{
+    // NOLINTNEXTLINE
+    static inline int alive = 0;
+
+    Tracked()
+    {
+        ++alive;
+    }
+
+    Tracked(Tracked&& /* other */) noexcept
+    {
+        ++alive;
+    }
+
+    Tracked(const Tracked& /* other */)
+    {
+        ++alive;
+    }
+
+    Tracked& operator=(Tracked&&) = default;
+    Tracked& operator=(const Tracked&) = default;
+
+    ~Tracked() noexcept
+    {
+        --alive;
+    }
+};
+
+template <>
+struct nil::luax::Meta<Tracked>
+{
+    using Constructors = nil::luax::List<nil::luax::Constructor<>>;
+};
+
+constexpr auto iterations = 1'000'000;
+
+TEST(luax, gc_closures)
+{
+    ASSERT_EQ(0, Tracked::alive);
+    {
+        auto state = nil::luax::State();
+        for (auto i = 0; i < iterations; ++i)
+        {
+            state.set("fn", [tracked = Tracked()]() { return 1; });
+        }
+        state.gc();
+        ASSERT_EQ(1, Tracked::alive);
+
+        state.run("fn = nil");
+        state.gc();
+        ASSERT_EQ(0, Tracked::alive);
+
+        state.set("fn", [tracked = Tracked()]() { return 1; });
+        ASSERT_EQ(1, Tracked::alive);
+    }
+    ASSERT_EQ(0, Tracked::alive);
+}
+
+TEST(luax, gc_user_types)
+{
+    ASSERT_EQ(0, Tracked::alive);
+    {
+        auto state = nil::luax::State();
+        state.add_type<Tracked>("Tracked");
+        state.run(R"(
+            for i = 1, 1000000 do
+                local value = Tracked()
+            end
+        )");
+        state.gc();
+        ASSERT_EQ(0, Tracked::alive);
+
+        for (auto i = 0; i < iterations; ++i)
+        {
+            state.set("value", Tracked());
+        }
+        state.gc();
+        ASSERT_EQ(1, Tracked::alive);
+
+        state.run(R"(
+            do
+                local value <close> = Tracked()
+            end
+        )");
+        ASSERT_EQ(1, Tracked::alive);
+        state.gc();
+        ASSERT_EQ(1, Tracked::alive);
+    }
+    ASSERT_EQ(0, Tracked::alive);
+}
@@ -0,0 +1,70 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <chrono>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr auto garbage = R"(
+        for i = 1, 20000 do
+            local t = { i, tostring(i) }
+        end
+    )";
+}
+
+TEST(luax, gc_step_incremental)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set_gc({.pause = 100, .stepmul = 200});
+    state.set_gc_running(false);
+    ASSERT_FALSE(state.gc_stats().running);
+
+    state.run(garbage);
+    const auto before = state.gc_stats().bytes;
+
+    // small budgets until one cycle completes
+    auto steps = 0;
+    while (!state.gc_step(50us))
+    {
+        ++steps;
+        ASSERT_LT(steps, 100000);
+    }
+
+    const auto stats = state.gc_stats();
+    ASSERT_LT(stats.bytes, before);
+    ASSERT_EQ(1, stats.cycles);
+    ASSERT_GE(stats.steps, std::uint64_t(steps) + 1);
+    ASSERT_GT(stats.time.count(), 0);
+    ASSERT_FALSE(stats.generational);
+
+    state.set_gc_running(true);
+    ASSERT_TRUE(state.gc_stats().running);
+}
+
+TEST(luax, gc_step_generational)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set_gc({.minormul = 10, .majormul = 50});
+    ASSERT_TRUE(state.gc_stats().generational);
+
+    // one collection per call, even with budget left and nothing to collect
+    state.run(garbage);
+    const auto before = state.gc_stats();
+    ASSERT_TRUE(state.gc_step(1s));
+    ASSERT_TRUE(state.gc_step(1s));
+    const auto after = state.gc_stats();
+    ASSERT_EQ(before.steps + 2, after.steps);
+    ASSERT_EQ(before.cycles + 2, after.cycles);
+    ASSERT_LT(after.time - before.time, 1s);
+    state.run(garbage);
+    state.gc();
+
+    state.set_gc(nil::luax::GcIncremental());
+    ASSERT_FALSE(state.gc_stats().generational);
+}
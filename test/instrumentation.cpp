@@ -0,0 +1,136 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct Counter
+    {
+        int value = 0;
+
+        int add(int amount)
+        {
+            value += amount;
+            return value;
+        }
+    };
+}
+
+template <>
+struct nil::luax::Meta<Counter>
+{
+    using Constructors = nil::luax::List<nil::luax::Constructor<>>;
+    using Members = nil::luax::List<
+        nil::luax::Property<"value", &Counter::value>,
+        nil::luax::Method<"add", &Counter::add>>;
+};
+
+#ifdef NIL_LUAX_INSTRUMENTATION
+
+namespace
+{
+    const nil::luax::BindingStats& find(
+        const std::vector<nil::luax::BindingStats>& stats,
+        std::string_view name
+    )
+    {
+        const auto it = std::find_if(
+            stats.begin(),
+            stats.end(),
+            [name](const nil::luax::BindingStats& entry) { return entry.name == name; }
+        );
+        if (it == stats.end())
+        {
+            throw std::invalid_argument("Error: no binding named [" + std::string(name) + "]");
+        }
+        return *it;
+    }
+
+    std::uint64_t histogram_total(const nil::luax::BindingStats& stats)
+    {
+        return std::accumulate(stats.histogram.begin(), stats.histogram.end(), std::uint64_t(0));
+    }
+}
+
+TEST(luax, instrumentation_closures)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set("square", [](int value) { return value * value; });
+    state.set(
+        "fail",
+        [](int value)
+        {
+            if (value > 2)
+            {
+                throw std::invalid_argument("Error: too big");
+            }
+        }
+    );
+    state.run(R"(
+        for i = 1, 10 do square(i) end
+        for i = 1, 5 do pcall(fail, i) end
+    )");
+
+    const auto stats = state.bindings();
+    const auto& square = find(stats, "square");
+    ASSERT_EQ("square", square.name);
+    ASSERT_EQ(10, square.calls);
+    ASSERT_EQ(0, square.errors);
+    ASSERT_EQ(10, histogram_total(square));
+
+    const auto& fail = find(stats, "fail");
+    ASSERT_EQ(5, fail.calls);
+    ASSERT_EQ(3, fail.errors);
+    ASSERT_GT(fail.total.count(), 0);
+
+    state.reset_bindings();
+    ASSERT_EQ(0, find(state.bindings(), "square").calls);
+}
+
+TEST(luax, instrumentation_bound)
+{
+    auto state = nil::luax::State();
+    auto counter = Counter();
+    state.set<&Counter::add>("add", &counter);
+    state.run("for i = 1, 3 do add(i) end");
+    ASSERT_EQ(3, find(state.bindings(), "add").calls);
+}
+
+TEST(luax, instrumentation_members)
+{
+    auto state = nil::luax::State();
+    state.add_type<Counter>("Counter");
+    state.run(R"(
+        local counter = Counter()
+        for i = 1, 4 do counter:add(i) end
+        counter.value = counter.value + 1
+        result = counter.value
+    )");
+    ASSERT_EQ(11, state.get("result").as<int>());
+
+    const auto stats = state.bindings();
+    ASSERT_EQ(4, find(stats, "Counter.add").calls);
+    ASSERT_EQ(2, find(stats, "Counter.value [get]").calls);
+    ASSERT_EQ(1, find(stats, "Counter.value [set]").calls);
+    ASSERT_EQ(3, stats.size());
+}
+
+#else
+
+TEST(luax, instrumentation_compiled_out)
+{
+    auto state = nil::luax::State();
+    state.set("square", [](int value) { return value * value; });
+    state.add_type<Counter>("Counter");
+    state.run("square(2) Counter():add(1)");
+    ASSERT_TRUE(state.bindings().empty());
+}
+
+#endif
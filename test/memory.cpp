@@ -0,0 +1,106 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+TEST(luax, memory_stats)
+{
+    auto state = nil::luax::State();
+    const auto initial = state.memory();
+    ASSERT_GT(initial.current, 0);
+    ASSERT_EQ(0, initial.limit);
+
+    state.open_libs();
+    state.run("data = {} for i = 1, 10000 do data[i] = { i } end");
+    const auto loaded = state.memory();
+    ASSERT_GT(loaded.current, initial.current + 10000 * 16);
+    ASSERT_GT(loaded.allocations, initial.allocations + 10000);
+
+    state.run("data = nil");
+    state.gc();
+    const auto collected = state.memory();
+    ASSERT_LT(collected.current, loaded.current);
+    ASSERT_GE(collected.peak, loaded.current);
+}
+
+TEST(luax, memory_limit)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set_memory_limit(state.memory().current + 512 * 1024);
+
+    const auto result = state.try_run("local s = string.rep('x', 1024 * 1024)");
+    ASSERT_FALSE(result);
+    ASSERT_EQ(nil::luax::Error::Status::memory, result.error().status);
+    ASSERT_LE(state.memory().current, state.memory().limit);
+    ASSERT_LE(state.memory().peak, state.memory().limit);
+
+    // a collection runs before failing, so garbage does not count against the limit
+    state.run(R"(
+        for i = 1, 100 do
+            local s = string.rep('x', 64 * 1024) .. i
+        end
+    )");
+
+    state.set_memory_limit(0);
+    state.run("local s = string.rep('x', 1024 * 1024)");
+}
+
+TEST(luax, memory_custom_allocator)
+{
+    auto allocator = nil::luax::PoolAllocator();
+    auto state = nil::luax::State(allocator);
+    state.open_libs();
+    state.set_memory_limit(state.memory().current + 256 * 1024);
+    const auto result = state.try_run("local t = {} for i = 1, 100000 do t[i] = {} end");
+    ASSERT_FALSE(result);
+    ASSERT_EQ(nil::luax::Error::Status::memory, result.error().status);
+}
+
+TEST(luax, memory_limit_host_operations)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set_memory_limit(state.memory().current + 256 * 1024);
+    const auto result = state.try_run("data = {} for i = 1, 1000000 do data[i] = { i } end");
+    ASSERT_FALSE(result);
+    ASSERT_EQ(nil::luax::Error::Status::memory, result.error().status);
+
+    // the quota is used up, the host can still push values, create references and register
+    state.set("payload", std::string(64 * 1024, 'x'));
+    state.set("size", [](const std::string& value) { return value.size(); });
+    const auto payload = state.get("payload");
+    ASSERT_EQ(64 * 1024, payload.as<std::string>().size());
+    ASSERT_GT(state.memory().current, state.memory().limit);
+
+    // while lua code is still refused
+    ASSERT_FALSE(state.try_run("copy = payload .. payload"));
+
+    state.set_memory_limit(0);
+    state.run("data = nil");
+}
+
+TEST(luax, memory_limit_load)
+{
+    const auto path = std::filesystem::temp_directory_path() / "luax-memory-limit-load.lua";
+    std::ofstream(path) << "value = 1";
+
+    auto state = nil::luax::State();
+    state.set_memory_limit(1);
+
+    // loading allocates too (the chunk name, the compiled function)
+    const auto loaded = state.try_load(path.string());
+    ASSERT_FALSE(loaded);
+    ASSERT_EQ(nil::luax::Error::Status::memory, loaded.error().status);
+    const auto ran = state.try_run("value = 2");
+    ASSERT_FALSE(ran);
+    ASSERT_EQ(nil::luax::Error::Status::memory, ran.error().status);
+
+    state.set_memory_limit(0);
+    state.load(path.string());
+    ASSERT_EQ(1, state.get("value").as<int>());
+    std::filesystem::remove(path);
+}
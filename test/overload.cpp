@@ -0,0 +1,138 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct Vec3
+    {
+        Vec3() = default;
+
+        Vec3(double init_x, double init_y, double init_z)
+            : x(init_x)
+            , y(init_y)
+            , z(init_z)
+        {
+        }
+
+        double x = 0.0;
+        double y = 0.0;
+        double z = 0.0;
+    };
+
+    std::string describe_int(int value)
+    {
+        return "int " + std::to_string(value);
+    }
+
+    std::string describe_number(double /* value */)
+    {
+        return "number";
+    }
+
+    std::string describe_bool(bool value)
+    {
+        return value ? "true" : "false";
+    }
+
+    std::string describe_pair(int l, int r)
+    {
+        return "pair " + std::to_string(l + r);
+    }
+
+    std::string describe_vec(const Vec3& value)
+    {
+        return "vec " + std::to_string(int(value.x + value.y + value.z));
+    }
+
+    int count_none()
+    {
+        return 0;
+    }
+}
+
+template <>
+struct nil::luax::Meta<Vec3>
+{
+    using Constructors = nil::luax::List<
+        nil::luax::Constructor<double, double, double>,
+        nil::luax::Constructor<const Vec3&>,
+        nil::luax::Constructor<>>;
+
+    using Members = nil::luax::List<
+        nil::luax::Property<"x", &Vec3::x>,
+        nil::luax::Property<"y", &Vec3::y>,
+        nil::luax::Property<"z", &Vec3::z>>;
+};
+
+TEST(luax, overload_constructor)
+{
+    auto state = nil::luax::State();
+    state.add_type<Vec3>("Vec3");
+    state.run(R"(
+        a = Vec3(1, 2, 3)
+        b = Vec3(a)
+        c = Vec3()
+        a.x = 10
+    )");
+
+    const auto& a = state.get("a").as<Vec3&>();
+    const auto& b = state.get("b").as<Vec3&>();
+    const auto& c = state.get("c").as<Vec3&>();
+    ASSERT_EQ(10.0, a.x);
+    ASSERT_EQ(1.0, b.x);
+    ASSERT_EQ(3.0, b.z);
+    ASSERT_EQ(0.0, c.y);
+
+    ASSERT_THROW(state.run("Vec3(1, 2)"), std::invalid_argument);
+    ASSERT_THROW(state.run("Vec3('a', 2, 3)"), std::invalid_argument);
+    ASSERT_THROW(state.run("Vec3({})"), std::invalid_argument);
+    ASSERT_THROW(state.run("Vec3(1, 2, 3, 4)"), std::invalid_argument);
+}
+
+TEST(luax, overload_function)
+{
+    auto state = nil::luax::State();
+    state.add_type<Vec3>("Vec3");
+    state.set<&describe_int, &describe_number, &describe_bool, &describe_vec, &describe_pair>(
+        "describe"
+    );
+    state.set<&count_none, &describe_int>("maybe");
+    state.run(R"(
+        i = describe(1)
+        n = describe(1.5)
+        s = describe('2.5')
+        b = describe(true)
+        v = describe(Vec3(1, 2, 3))
+        p = describe(1, 2)
+        none = maybe()
+        one = maybe(4)
+    )");
+    ASSERT_EQ("int 1", state.get("i").as<std::string>());
+    ASSERT_EQ("number", state.get("n").as<std::string>());
+    ASSERT_EQ("number", state.get("s").as<std::string>());
+    ASSERT_EQ("true", state.get("b").as<std::string>());
+    ASSERT_EQ("vec 6", state.get("v").as<std::string>());
+    ASSERT_EQ("pair 3", state.get("p").as<std::string>());
+    ASSERT_EQ(0, state.get("none").as<int>());
+    ASSERT_EQ("int 4", state.get("one").as<std::string>());
+}
+
+TEST(luax, overload_function_no_match)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.set<&describe_int, &describe_pair>("describe");
+    state.run(R"(
+        ok, message = pcall(describe, 'text')
+        ok_count, message_count = pcall(describe, 1, 2, 3)
+    )");
+    ASSERT_FALSE(state.get("ok").as<bool>());
+    ASSERT_THAT(state.get("message").as<std::string>(), testing::HasSubstr("no overload"));
+    ASSERT_FALSE(state.get("ok_count").as<bool>());
+    ASSERT_THAT(state.get("message_count").as<std::string>(), testing::HasSubstr("no overload"));
+}
@@ -0,0 +1,86 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <functional>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    std::uint64_t total(const std::string& folded)
+    {
+        auto stream = std::istringstream(folded);
+        std::uint64_t sum = 0;
+        for (auto line = std::string(); std::getline(stream, line);)
+        {
+            sum += std::stoull(line.substr(line.rfind(' ') + 1));
+        }
+        return sum;
+    }
+}
+
+TEST(luax, profiler_folded)
+{
+    auto state = nil::luax::State();
+    state.set(
+        "each",
+        std::function<void(int, const nil::luax::Var&)>(
+            [](int count, const nil::luax::Var& fn)
+            {
+                const auto call = fn.as<nil::luax::Function<void(int)>>();
+                for (auto i = 0; i < count; ++i)
+                {
+                    call(i);
+                }
+            }
+        )
+    );
+    state.run(R"(
+        local function inner(n)
+            local total = 0
+            for i = 1, n do total = total + i end
+            return total
+        end
+        function outer()
+            each(200, function(i) inner(1000) end)
+        end
+    )");
+
+    state.start_profiler(1000);
+    state.run("outer()");
+    state.stop_profiler();
+
+    const auto folded = state.profiler().folded();
+    ASSERT_GT(state.profiler().samples(), 100);
+    ASSERT_EQ(state.profiler().samples(), total(folded));
+    // lua frames, the c++ binding in between, root first
+    ASSERT_THAT(folded, testing::HasSubstr("outer ("));
+    ASSERT_THAT(folded, testing::HasSubstr("each [C];? ("));
+    ASSERT_THAT(folded, testing::HasSubstr(";inner ("));
+    ASSERT_THAT(folded, testing::StartsWith("main ("));
+
+    // stopped: nothing is recorded
+    const auto samples = state.profiler().samples();
+    state.run("outer()");
+    ASSERT_EQ(samples, state.profiler().samples());
+
+    state.profiler().clear();
+    ASSERT_EQ(0, state.profiler().samples());
+    ASSERT_TRUE(state.profiler().folded().empty());
+}
+
+TEST(luax, profiler_with_budget)
+{
+    auto state = nil::luax::State();
+    state.start_profiler(100);
+    state.set_budget({.instructions = 100000});
+    ASSERT_THROW(state.run("while true do end"), nil::luax::BudgetError);
+    // both share the hook
+    ASSERT_GE(state.profiler().samples(), 900);
+
+    state.clear_budget();
+    state.run("for i = 1, 10000 do end");
+    ASSERT_GE(state.profiler().samples(), 1000);
+}
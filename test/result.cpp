@@ -0,0 +1,102 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+struct ResultType
+{
+    int value = 0;
+};
+
+template <>
+struct nil::luax::Meta<ResultType>
+{
+};
+
+TEST(luax, result_run)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+
+    ASSERT_TRUE(state.try_run("value = 1"));
+
+    {
+        const auto result = state.try_run("value = ");
+        ASSERT_FALSE(result);
+        ASSERT_EQ(nil::luax::Error::Status::syntax, result.error().status);
+        ASSERT_THROW(result.value(), std::invalid_argument);
+    }
+    {
+        const auto result = state.try_run("error('failed')");
+        ASSERT_FALSE(result);
+        ASSERT_EQ(nil::luax::Error::Status::runtime, result.error().status);
+        ASSERT_THAT(result.error().message(), testing::HasSubstr("failed"));
+    }
+    {
+        const auto result = state.try_load("/does/not/exist.lua");
+        ASSERT_FALSE(result);
+        ASSERT_EQ(nil::luax::Error::Status::file, result.error().status);
+    }
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, result_call)
+{
+    auto state = nil::luax::State();
+    state.open_libs();
+    state.run(R"(
+        function add(a, b) return a + b end
+        function name() return "name" end
+        function fail() error({}) end
+    )");
+
+    auto add = state.get("add").as<nil::luax::Function<int(int, int)>>();
+    {
+        const auto result = add.try_call(1, 2);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(3, *result);
+    }
+
+    auto name = state.get("name").as<nil::luax::Function<int()>>();
+    {
+        const auto result = name.try_call();
+        ASSERT_FALSE(result);
+        const auto& error = result.error();
+        ASSERT_EQ(nil::luax::Error::Status::type, error.status);
+        ASSERT_EQ(-1, error.index);
+        ASSERT_STREQ("string", error.actual);
+        ASSERT_EQ("expected [int], got [string]", error.message());
+    }
+
+    auto fail = state.get("fail").as<nil::luax::Function<void()>>();
+    {
+        const auto result = fail.try_call();
+        ASSERT_FALSE(result);
+        ASSERT_EQ(nil::luax::Error::Status::runtime, result.error().status);
+        ASSERT_EQ("(error object is not a string)", result.error().message());
+    }
+    ASSERT_EQ(0, state.stack_depth());
+}
+
+TEST(luax, result_as)
+{
+    auto state = nil::luax::State();
+    auto object = ResultType{.value = 3};
+    state.set("integer", 1);
+    state.set("object", object);
+    state.run("text = 'text'");
+
+    ASSERT_EQ(1, *state.get("integer").try_as<int>());
+    ASSERT_EQ("text", *state.get("text").try_as<std::string>());
+    ASSERT_EQ(&object, &*state.get("object").try_as<ResultType&>());
+    ASSERT_EQ(3, state.get("object").try_as<ResultType&>()->value);
+
+    const auto result = state.get("text").try_as<bool>();
+    ASSERT_FALSE(result);
+    ASSERT_EQ(nil::luax::Error::Status::type, result.error().status);
+    ASSERT_STREQ("string", result.error().actual);
+
+    ASSERT_FALSE(state.get("integer").try_as<ResultType&>());
+    ASSERT_FALSE(state.get("integer").try_as<nil::luax::Function<void()>>());
+    ASSERT_EQ(0, state.stack_depth());
+}
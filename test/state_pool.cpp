@@ -0,0 +1,105 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    void setup(nil::luax::State& state)
+    {
+        state.open_libs();
+        state.run(R"(
+            function square(value)
+                return value * value
+            end
+        )");
+    }
+}
+
+TEST(luax, state_pool_submit)
+{
+    auto pool = nil::luax::StatePool(4, setup);
+    ASSERT_EQ(4, pool.size());
+
+    auto results = std::vector<std::future<int>>();
+    for (auto i = 0; i < 100; ++i)
+    {
+        results.push_back(pool.submit(
+            [i](nil::luax::State& state)
+            { return state.get("square").as<std::function<int(int)>>()(i); }
+        ));
+    }
+    for (auto i = 0; i < 100; ++i)
+    {
+        ASSERT_EQ(i * i, results[std::size_t(i)].get());
+    }
+
+    std::uint64_t jobs = 0;
+    for (const auto& stats : pool.stats())
+    {
+        jobs += stats.jobs;
+        ASSERT_GE(stats.utilization(), 0.0);
+        ASSERT_LE(stats.utilization(), 1.0);
+    }
+    ASSERT_EQ(100, jobs);
+}
+
+TEST(luax, state_pool_exception)
+{
+    auto pool = nil::luax::StatePool(2, setup);
+    auto result = pool.submit([](nil::luax::State& state) { state.run("error('failed')"); });
+    ASSERT_THROW(result.get(), std::invalid_argument);
+
+    // the worker is still usable
+    auto next = pool.submit([](nil::luax::State& state) { return state.stack_depth(); });
+    ASSERT_EQ(0, next.get());
+}
+
+TEST(luax, state_pool_steal)
+{
+    auto pool = nil::luax::StatePool(2, setup);
+    // nested jobs are queued on the worker blocked in the outer job.
+    // they can only complete by being stolen by the other worker.
+    auto outer = pool.submit(
+        [&pool](nil::luax::State& /* state */)
+        {
+            auto inner = std::vector<std::future<int>>();
+            for (auto i = 0; i < 4; ++i)
+            {
+                inner.push_back(pool.submit([i](nil::luax::State& /* state */) { return i; }));
+            }
+            auto sum = 0;
+            for (auto& result : inner)
+            {
+                sum += result.get();
+            }
+            return sum;
+        }
+    );
+    ASSERT_EQ(6, outer.get());
+
+    std::uint64_t steals = 0;
+    for (const auto& stats : pool.stats())
+    {
+        steals += stats.steals;
+    }
+    // the outer job itself may also have been stolen
+    ASSERT_GE(steals, 4);
+}
+
+TEST(luax, state_pool_drains_on_destruction)
+{
+    auto count = std::atomic<int>(0);
+    {
+        auto pool = nil::luax::StatePool(3, setup);
+        for (auto i = 0; i < 50; ++i)
+        {
+            pool.submit([&count](nil::luax::State& /* state */) { ++count; });
+        }
+    }
+    ASSERT_EQ(50, count.load());
+}
@@ -0,0 +1,77 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <nil/luax.hpp>
+
+#include <functional>
+#include <vector>
+
+TEST(luax, var_outlives_global)
+{
+    auto state = nil::luax::State();
+
+    state.set("value", 1);
+    auto var = state.get("value");
+    state.set("value", 2);
+
+    ASSERT_EQ(1, var.as<int>());
+    ASSERT_EQ(2, state.get("value").as<int>());
+}
+
+TEST(luax, var_copies_share_value)
+{
+    auto state = nil::luax::State();
+
+    state.set("value", 1);
+    auto copy = [&]()
+    {
+        auto var = state.get("value");
+        auto c = var;
+        return c;
+    }();
+    auto moved = std::move(copy);
+
+    // the slot released by `var` must not be reused while `moved` is alive
+    state.set("value", 2);
+    auto other = state.get("value");
+
+    ASSERT_EQ(1, moved.as<int>());
+    ASSERT_EQ(2, other.as<int>());
+
+    moved = other;
+    ASSERT_EQ(2, moved.as<int>());
+}
+
+TEST(luax, var_nil)
+{
+    auto state = nil::luax::State();
+
+    auto var = state.get("undefined");
+    auto copy = var;
+    state.set("value", 1);
+
+    ASSERT_ANY_THROW(copy.as<int>());
+}
+
+TEST(luax, var_slot_reuse)
+{
+    auto state = nil::luax::State();
+    state.run("function add(a, b) return a + b end");
+
+    for (auto i = 0; i < 100; ++i)
+    {
+        auto vars = std::vector<nil::luax::Var>();
+        for (auto j = 0; j < 1000; ++j)
+        {
+            state.set("value", int(j));
+            vars.push_back(state.get("value"));
+        }
+        std::function<int(int, int)> add = state.get("add");
+        for (auto j = 0; j < 1000; ++j)
+        {
+            ASSERT_EQ(j + i, add(vars[std::size_t(j)].as<int>(), i));
+        }
+    }
+    state.gc();
+    ASSERT_EQ(0, state.stack_depth());
+}
@@ -0,0 +1,154 @@
+extern "C"
+{
+#include <lauxlib.h>
+#include <lua.h>
+}
+
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Compiles lua scripts to bytecode and writes them to a header as `EmbeddedModule`s.
+ *
+ * usage: luax-embed <output.hpp> <symbol> <module>=<file>...
+ *
+ * the header is only rewritten when its content changes so that dependents are not
+ * rebuilt needlessly. see `target_embed_lua` in `cmake/embed.cmake`.
+ */
+
+namespace
+{
+    struct Module
+    {
+        std::string name;
+        std::string path;
+    };
+
+    using state_ptr = std::unique_ptr<lua_State, decltype(&lua_close)>;
+
+    int dump_writer(lua_State* /* state */, const void* data, std::size_t size, void* output)
+    {
+        static_cast<std::string*>(output)->append(static_cast<const char*>(data), size);
+        return 0;
+    }
+
+    bool compile(lua_State* state, const Module& module, std::string& bytecode)
+    {
+        auto file = std::ifstream(module.path, std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "luax-embed: can't open [" << module.path << "]\n";
+            return false;
+        }
+        auto source = std::string(std::istreambuf_iterator<char>(file), {});
+
+        // same handling as luaL_loadfile for a leading '#' line
+        if (source.starts_with('#'))
+        {
+            source.erase(0, source.find('\n'));
+        }
+
+        // the module name is used as chunk name (no build paths in the binary)
+        const auto chunkname = "=" + module.name;
+        if (luaL_loadbufferx(state, source.data(), source.size(), chunkname.c_str(), "t")
+            != LUA_OK)
+        {
+            std::cerr << "luax-embed: " << lua_tostring(state, -1) << '\n';
+            lua_pop(state, 1);
+            return false;
+        }
+        lua_dump(state, &dump_writer, &bytecode, 0);
+        lua_pop(state, 1);
+        return true;
+    }
+
+    std::string generate(std::string_view symbol, const std::vector<Module>& modules)
+    {
+        auto out = std::ostringstream();
+        out << "#pragma once\n\n"
+            << "// generated by luax-embed, do not edit\n\n"
+            << "#include <nil/luax/Embedded.hpp>\n\n"
+            << "namespace " << symbol << "_data\n{\n";
+
+        auto state = state_ptr(luaL_newstate(), &lua_close);
+        for (std::size_t i = 0; i < modules.size(); ++i)
+        {
+            auto bytecode = std::string();
+            if (!compile(state.get(), modules[i], bytecode))
+            {
+                return {};
+            }
+            out << "    inline constexpr unsigned char m" << i << "[] = {";
+            for (std::size_t j = 0; j < bytecode.size(); ++j)
+            {
+                out << (j % 16 == 0 ? "\n        " : " ")
+                    << unsigned(static_cast<unsigned char>(bytecode[j])) << ',';
+            }
+            out << "\n    };\n";
+        }
+        out << "}\n\n"
+            << "inline constexpr nil::luax::EmbeddedModule " << symbol << "[] = {\n";
+        for (std::size_t i = 0; i < modules.size(); ++i)
+        {
+            out << "    {\"" << modules[i].name << "\", " << symbol << "_data::m" << i << "},\n";
+        }
+        out << "};\n";
+        return out.str();
+    }
+
+    bool write_if_changed(const std::string& path, const std::string& content)
+    {
+        {
+            auto file = std::ifstream(path, std::ios::binary);
+            if (file && std::string(std::istreambuf_iterator<char>(file), {}) == content)
+            {
+                return true;
+            }
+        }
+        auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        file << content;
+        return bool(file);
+    }
+}
+
+int main(int argc, const char** argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "usage: luax-embed <output.hpp> <symbol> <module>=<file>...\n";
+        return 1;
+    }
+
+    auto modules = std::vector<Module>();
+    for (int i = 3; i < argc; ++i)
+    {
+        const auto arg = std::string_view(argv[i]);
+        const auto separator = arg.find('=');
+        if (separator == 0 || separator == std::string_view::npos)
+        {
+            std::cerr << "luax-embed: expected <module>=<file>, got [" << arg << "]\n";
+            return 1;
+        }
+        modules.push_back({std::string(arg.substr(0, separator)),
+                           std::string(arg.substr(separator + 1))});
+    }
+
+    const auto content = generate(argv[2], modules);
+    if (content.empty())
+    {
+        return 1;
+    }
+    if (!write_if_changed(argv[1], content))
+    {
+        std::cerr << "luax-embed: can't write [" << argv[1] << "]\n";
+        return 1;
+    }
+    return 0;
+}